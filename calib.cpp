@@ -0,0 +1,164 @@
+/****************************************************
+ * Calibration of the pedestal and of the noise of
+ * each wire
+ *
+ * For each hit of AHDC::wf : the pedestal (mean of
+ * the first valid samples), the RMS and the number
+ * of valid samples (see fKernels::waveform_stats).
+ * They are averaged per wire and saved in a table
+ * (see fCalibration) given to the other tools, e.g
+ *     ./calib.exe run.hipo          -> run.fcal
+ *     ./shape.exe run.hipo run.fcal
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * *************************************************/
+
+#include "reader.h"
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+#include "fPipeline.h"
+#include "fWaveformBatch.h"
+#include "fKernels.h"
+#include "fChannelMap.h"
+#include "fCalibration.h"
+
+/** sums over the hits of a wire */
+struct WireSums {
+	long nhits = 0;
+	long ntruncated = 0;
+	double pedestal = 0;
+	double pedestal2 = 0; ///< sum of the squares
+	double rms = 0;
+	double length = 0;
+	WireSums& operator+=(const WireSums& other) {
+		nhits += other.nhits;
+		ntruncated += other.ntruncated;
+		pedestal += other.pedestal;
+		pedestal2 += other.pedestal2;
+		rms += other.rms;
+		length += other.length;
+		return *this;
+	}
+};
+
+/** state of a thread */
+struct CalibState {
+	fChannelArray<WireSums> wires;
+	fWaveformBatch batch; ///< waveforms of the current record
+	fWaveformStats stats;
+	fAlignedVector<float> pedestals; ///< one per hit of the batch
+	long nevents = 0;
+};
+
+int main(int argc, char const *argv[]){
+
+	// option of calib.exe, the others are given to fPipeline
+	int npedestal = 5;
+	std::vector<const char*> rest;
+	for (int i = 0; i < argc; i++) {
+		if ((strcmp(argv[i], "--npedestal") == 0) && (i + 1 < argc)) { npedestal = atoi(argv[++i]);}
+		else { rest.push_back(argv[i]);}
+	}
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(rest.size(), rest.data(), options);
+	bool valid = (npedestal >= 1) && (npedestal <= fWaveformBatch::nsamples) && (options.nshards == 1);
+	if ((args.size() < 2) || (args.size() > 3) || !valid) {
+		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./calib.exe filename [output] [--npedestal N] [options]\n");
+		printf("      output         calibration table (filename without .hipo + .fcal by default)\n");
+		printf("      --npedestal N  first samples averaged for the pedestal of a hit (1 to 50, 5 by default)\n");
+		printf("%s", fPipeline::getOptionsUsage());
+		printf("   (without --shard, the whole file is needed)\n");
+		return 0;
+	}
+	const char* filename = args[1];
+	std::string output = (args.size() == 3) ? args[2] : fCalibration::getDefaultName(filename);
+
+	fPipeline pipeline(filename, {{"AHDC::wf", fWaveformBatch::getColumns()}});
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+	CalibState model = {fChannelArray<WireSums>(), fWaveformBatch(pipeline.getBank(0).getSchema()), fWaveformStats(), {}, 0};
+	CalibState result = pipeline.run<CalibState>(model,
+		[] (CalibState& state, hipo::banklist& banklist, long nEvent) {
+		state.batch.add_event(banklist[0], nEvent); // AHDC::wf
+		state.nevents++;
+	},
+	[] (CalibState& state, const CalibState& other) {
+		state.wires.merge(other.wires);
+		state.nevents += other.nevents;
+	},
+	[npedestal] (CalibState& state) { // all the waveforms of a record at once
+		fWaveformBatch& batch = state.batch;
+		int nhits = batch.getNumberOfHits();
+		fKernels::waveform_stats(batch, state.stats);
+		// pedestal : mean of the first samples, only the valid ones
+		state.pedestals.resize(nhits);
+		float* ped = state.pedestals.data();
+		const int16_t* length = state.stats.length.data();
+		for (int hit = 0; hit < nhits; hit++) { ped[hit] = 0;}
+		for (int s = 0; s < npedestal; s++) {
+			const int16_t* x = batch.getSamples(s);
+			#pragma omp simd
+			for (int hit = 0; hit < nhits; hit++) {
+				ped[hit] += (s < length[hit]) ? x[hit] : 0;
+			}
+		}
+		#pragma omp simd
+		for (int hit = 0; hit < nhits; hit++) {
+			int n = (length[hit] < npedestal) ? length[hit] : npedestal;
+			ped[hit] = ped[hit]/n;
+		}
+		for (int hit = 0; hit < nhits; hit++) {
+			int channel = fChannelMap::getChannel(batch.getLayers()[hit], batch.getComponents()[hit]);
+			if (channel < 0) { continue;}
+			WireSums& wire = state.wires[channel];
+			wire.nhits++;
+			wire.ntruncated += (length[hit] < fWaveformBatch::nsamples);
+			wire.pedestal += ped[hit];
+			wire.pedestal2 += ((double) ped[hit])*ped[hit];
+			wire.rms += state.stats.getRms(hit);
+			wire.length += length[hit];
+		}
+		batch.clear();
+	});
+
+	fCalibration calibration(filename, npedestal);
+	calibration.set_nevents(result.nevents);
+	int nwires = 0;
+	for (int channel = 0; channel < fChannelMap::nchannels; channel++) {
+		const WireSums& wire = result.wires[channel];
+		if (wire.nhits == 0) { continue;}
+		double mean = wire.pedestal/wire.nhits;
+		double variance = wire.pedestal2/wire.nhits - mean*mean;
+		fCalibration::Entry entry;
+		entry.pedestal = mean;
+		entry.pedestal_sigma = (variance > 0) ? sqrt(variance) : 0;
+		entry.rms = wire.rms/wire.nhits;
+		entry.length = wire.length/wire.nhits;
+		entry.nhits = wire.nhits;
+		entry.ntruncated = wire.ntruncated;
+		calibration.set_entry(channel, entry);
+		nwires++;
+	}
+	if (!calibration.write(output)) { return 0;}
+	printf("%s : %ld events, %d/%d wires with data\n", output.c_str(), result.nevents, nwires, fChannelMap::nchannels);
+	for (int index = 0; index < fChannelMap::nlayers; index++) {
+		double pedestal = 0, rms = 0;
+		long nhits = 0;
+		for (int channel = fChannelMap::getFirstChannel(index); channel < fChannelMap::getFirstChannel(index) + fChannelMap::getNumberOfWires(index); channel++) {
+			pedestal += calibration[channel].pedestal*calibration[channel].nhits;
+			rms += calibration[channel].rms*calibration[channel].nhits;
+			nhits += calibration[channel].nhits;
+		}
+		if (nhits > 0) {
+			printf("   layer %d : pedestal %7.1lf, rms %7.1lf, %ld hits\n", fChannelMap::getLayerCode(index), pedestal/nhits, rms/nhits, nhits);
+		}
+	}
+	return 0;
+}
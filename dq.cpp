@@ -0,0 +1,80 @@
+/****************************************************
+ * Data quality : the studies of hits, noise_count,
+ * rms and first_channel in one pass over the file
+ *
+ * Each event is read and decompressed once, the
+ * decoded banks are shared by all the modules (see
+ * fModule.h).
+ *
+ * With --follow, the file being written is
+ * processed as it grows and dq.fhist is written
+ * again after each poll (see hmerge.exe to read it).
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * *************************************************/
+
+#include "reader.h"
+
+#include <string>
+#include <cstdio>
+#include <vector>
+
+#include "fPipeline.h"
+#include "fModule.h"
+
+
+int main(int argc, char const *argv[]){
+	
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	if (args.size() < 2) {
+		printf("Please, provide a filename...\n");
+		printf("Usage :\n");
+		printf("   ./dq.exe filename [module ...] [options]\n");
+		printf("   modules : cosmics noise rms time (all by default)\n");
+		printf("%s", fPipeline::getOptionsUsage());
+		return 0;
+	}
+
+	std::vector<std::string> names;
+	for (int i = 2; i < (int) args.size(); i++) {
+		names.push_back(args[i]);
+	}
+	if (names.empty()) {
+		names = fModuleList::getModuleNames();
+	}
+	// only the banks and columns of the selected modules are read
+	std::vector<fColumns> projection;
+	if (!fModuleList::add_columns(names, projection)) { return 0;}
+
+	// open file and read bank
+	const char* filename = args[1];
+	fPipeline pipeline(filename, projection);
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+
+	fModuleList modules;
+	for (std::string name : names) {
+		modules.add(name, pipeline);
+	}
+
+	// loop over events
+	fModuleList result = pipeline.run<fModuleList>(modules,
+		[] (fModuleList& list, hipo::banklist& banklist, long nEvent) {
+		list.process(banklist, nEvent);
+	},
+	[] (fModuleList& list, const fModuleList& other) { list.merge(other);},
+	[] (fModuleList& list) { list.flush();},
+	[&options] (const fModuleList& list) { // --follow : histograms so far
+		fHistWriter writer;
+		list.save(writer);
+		writer.write("dq" + options.getSuffix() + ".fhist");
+	});
+	std::string prefix = "dq" + options.getSuffix();
+	result.finish(prefix);
+	// histograms of the shard, see hmerge.exe
+	fHistWriter writer;
+	result.save(writer);
+	writer.write(prefix + ".fhist");
+	printf("   > %s.fhist\n", prefix.c_str());
+}
@@ -0,0 +1,314 @@
+/****************************************************
+ * Data quality daemon : watch a directory of run
+ * files and run the modules of dq.exe on each new
+ * file
+ *
+ * The directory is listed every few seconds, a
+ * .hipo file is processed once its size has not
+ * changed for a quiet period (--quiet, 10 minutes
+ * by default) : the DAQ may write nothing for
+ * minutes during a cosmic run, the quiet period
+ * must be much longer than the time between two
+ * records. The files wait in a queue for one of the
+ * jobs, each job runs a fPipeline with its share
+ * of the cores. For each file :
+ *   - output/<file>/dq_*.pdf and dq.fhist (see
+ *     dq.cpp, hmerge.exe),
+ *   - a line in output/dqd_summary.txt : id, run,
+ *     number of events, seconds, a few numbers per
+ *     module (fModule::summary), the size and the
+ *     name of the file.
+ *
+ * A header line gives the names of the columns,
+ * it is written again if the modules change.
+ * The files already in the summary are not
+ * processed again (e.g after a restart), unless
+ * they have grown since : a file processed too
+ * early is processed again when it is complete,
+ * the last line of a file is the valid one.
+ * Ctrl-C stops the daemon after the files in
+ * progress.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * *************************************************/
+
+#include "reader.h"
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <csignal>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "fPipeline.h"
+#include "fModule.h"
+
+static volatile sig_atomic_t stop_requested = 0;
+
+/** a second Ctrl-C kills the program */
+static void request_stop(int) {
+	stop_requested = 1;
+	signal(SIGINT, SIG_DFL);
+}
+
+/** e.g clas_021039.evio.00005.hipo -> clas_021039.evio.00005 */
+static std::string base_name(const std::string& path) {
+	size_t slash = path.find_last_of('/');
+	std::string base = (slash == std::string::npos) ? path : path.substr(slash + 1);
+	size_t dot = base.find_last_of('.');
+	return ((dot != std::string::npos) && (dot > 0)) ? base.substr(0, dot) : base;
+}
+
+/** first number of the file name, 0 if none (e.g clas_021039.evio.00005.hipo -> 21039) */
+static long run_number(const std::string& path) {
+	std::string base = base_name(path);
+	size_t digit = base.find_first_of("0123456789");
+	return (digit == std::string::npos) ? 0 : atol(base.c_str() + digit);
+}
+
+/** .hipo files of the directory and their size */
+static std::map<std::string, long> list_files(const std::string& directory) {
+	std::map<std::string, long> files;
+	DIR* dir = opendir(directory.c_str());
+	if (dir == NULL) { return files;}
+	while (struct dirent* entry = readdir(dir)) {
+		std::string name = entry->d_name;
+		if ((name.size() < 6) || (name.compare(name.size() - 5, 5, ".hipo") != 0)) { continue;}
+		std::string path = directory + "/" + name;
+		struct stat info;
+		if ((stat(path.c_str(), &info) == 0) && S_ISREG(info.st_mode)) {
+			files[path] = info.st_size;
+		}
+	}
+	closedir(dir);
+	return files;
+}
+
+/**
+ * the files already in the summary (last column) and their size
+ * (column before, -1 in the summaries without sizes), its number
+ * of lines and its last header
+ */
+static std::map<std::string, long> read_summary(const std::string& filename, int& nlines, std::string& header) {
+	std::map<std::string, long> done;
+	nlines = 0;
+	FILE* file = fopen(filename.c_str(), "r");
+	if (file == NULL) { return done;}
+	char line[4096];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (line[0] == '#') {
+			header = line;
+			continue;
+		}
+		std::string text = line;
+		text.erase(text.find_last_not_of(" \t\r\n") + 1);
+		size_t sep = text.find_last_of(" \t");
+		if (sep != std::string::npos) {
+			bool has_size = (header.find("\tsize\tfile") != std::string::npos);
+			size_t before = text.find_last_of(" \t", sep - 1);
+			long size = (has_size && (before != std::string::npos)) ? atol(text.c_str() + before + 1) : -1;
+			done[text.substr(sep + 1)] = size;
+			nlines++;
+		}
+	}
+	fclose(file);
+	return done;
+}
+
+/** state of a thread of the pipeline of a file */
+struct RunState {
+	fModuleList modules;
+	long nevents = 0;
+};
+
+int main(int argc, char const *argv[]){
+
+	// options of the daemon, the others are given to fPipeline
+	int njobs = 1;
+	double poll = 10;
+	double quiet = 600;
+	bool once = false;
+	std::string output = ".";
+	std::vector<const char*> rest;
+	for (int i = 0; i < argc; i++) {
+		bool has_value = (i + 1 < argc);
+		if      ((strcmp(argv[i], "--jobs") == 0) && has_value)   { njobs = atoi(argv[++i]);}
+		else if ((strcmp(argv[i], "--poll") == 0) && has_value)   { poll = atof(argv[++i]);}
+		else if ((strcmp(argv[i], "--quiet") == 0) && has_value)  { quiet = atof(argv[++i]);}
+		else if ((strcmp(argv[i], "--output") == 0) && has_value) { output = argv[++i];}
+		else if (strcmp(argv[i], "--once") == 0)                  { once = true;}
+		else { rest.push_back(argv[i]);}
+	}
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(rest.size(), rest.data(), options);
+	bool valid = (njobs >= 1) && (poll > 0) && (quiet >= poll) && (options.nshards == 1) && options.index.empty() && (options.follow == 0);
+	if ((args.size() < 2) || !valid) {
+		printf("Please, provide a directory...\n");
+		printf("Usage :\n");
+		printf("   ./dqd.exe directory [module ...] [--jobs J] [--poll S] [--quiet S] [--output dir] [--once] [options]\n");
+		printf("   modules : cosmics noise rms time (all by default)\n");
+		printf("      --jobs J      files processed at the same time (1 by default)\n");
+		printf("      --poll S      seconds between two listings of the directory (10 by default)\n");
+		printf("      --quiet S     a file is complete when its size has not changed for S seconds (600 by default, >= --poll)\n");
+		printf("      --output dir  directory of the outputs and of dqd_summary.txt (. by default)\n");
+		printf("      --once        process the files of the directory and exit\n");
+		printf("%s", fPipeline::getOptionsUsage());
+		printf("   (without --shard, --index and --follow)\n");
+		return 0;
+	}
+	std::string directory = args[1];
+	std::vector<std::string> names;
+	for (int i = 2; i < (int) args.size(); i++) {
+		names.push_back(args[i]);
+	}
+	if (names.empty()) {
+		names = fModuleList::getModuleNames();
+	}
+	std::vector<fColumns> projection;
+	if (!fModuleList::add_columns(names, projection)) { return 0;}
+	mkdir(output.c_str(), 0755);
+
+	// summary of the runs
+	std::string summary_name = output + "/dqd_summary.txt";
+	int nlines = 0;
+	std::string header; // names of the columns
+	std::map<std::string, long> done = read_summary(summary_name, nlines, header); // file -> size processed
+	std::mutex summary_mutex; // protects the summary file, nlines, header and the prints of the jobs
+	printf("dqd : %s, %d files already processed (%s)\n", directory.c_str(), nlines, summary_name.c_str());
+
+	// queue of the files to process
+	std::deque<std::pair<std::string, long>> queue; // file and size
+	std::mutex queue_mutex;
+	std::condition_variable cv_queue;
+	bool finished = false;
+
+	int nthreads = std::max(1, (int) std::thread::hardware_concurrency()/njobs);
+	auto process_file = [&] (const std::string& path, long size) {
+		auto start = std::chrono::steady_clock::now();
+		fPipeline pipeline(path, projection, nthreads);
+		if (!pipeline.is_valid() || !pipeline.set_options(options)) { return ;}
+		RunState model;
+		for (std::string name : names) {
+			model.modules.add(name, pipeline);
+		}
+		RunState result = pipeline.run<RunState>(model,
+			[] (RunState& state, hipo::banklist& banklist, long nEvent) {
+				state.modules.process(banklist, nEvent);
+				state.nevents++;
+			},
+			[] (RunState& state, const RunState& other) {
+				state.modules.merge(other.modules);
+				state.nevents += other.nevents;
+			},
+			[] (RunState& state) { state.modules.flush();});
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::string rundir = output + "/" + base_name(path);
+		mkdir(rundir.c_str(), 0755);
+		std::vector<std::string> columns;
+		std::vector<double> values;
+		result.modules.summary(columns, values);
+		std::lock_guard<std::mutex> lock(summary_mutex);
+		printf("===== %s : %ld events in %.1lf s =====\n", path.c_str(), result.nevents, seconds);
+		result.modules.finish(rundir + "/dq");
+		fHistWriter writer;
+		result.modules.save(writer);
+		writer.write(rundir + "/dq.fhist");
+		FILE* file = fopen(summary_name.c_str(), "a");
+		if (file == NULL) {
+			perror("Error opening file\n");
+			return ;
+		}
+		std::string new_header = "# id\trun\tevents\tseconds";
+		for (const std::string& column : columns) {
+			new_header += "\t" + column;
+		}
+		new_header += "\tsize\tfile\n";
+		if (new_header != header) { // first line or other modules
+			fprintf(file, "%s", new_header.c_str());
+			header = new_header;
+		}
+		fprintf(file, "%d\t%ld\t%ld\t%.1lf", ++nlines, run_number(path), result.nevents, seconds);
+		for (double value : values) {
+			fprintf(file, "\t%lg", value);
+		}
+		fprintf(file, "\t%ld\t%s\n", size, path.c_str());
+		fclose(file);
+	};
+
+	std::vector<std::thread> jobs;
+	for (int job = 0; job < njobs; job++) {
+		jobs.emplace_back([&] () {
+			while (true) {
+				std::pair<std::string, long> file;
+				{
+					std::unique_lock<std::mutex> lock(queue_mutex);
+					cv_queue.wait(lock, [&] { return !queue.empty() || finished;});
+					if (queue.empty() || stop_requested) { return ;}
+					file = queue.front();
+					queue.pop_front();
+				}
+				process_file(file.first, file.second);
+			}
+		});
+	}
+
+	// watch the directory : a file is ready when its size has not changed for the quiet period
+	signal(SIGINT, request_stop);
+	struct Seen {
+		long size;
+		std::chrono::steady_clock::time_point since; ///< last change of the size
+	};
+	std::map<std::string, Seen> seen;
+	while (!stop_requested) {
+		std::map<std::string, long> files = list_files(directory);
+		auto now = std::chrono::steady_clock::now();
+		for (const auto& file : files) {
+			auto processed = done.find(file.first);
+			// processed, and not grown since (size unknown : old summary)
+			if ((processed != done.end()) && ((processed->second < 0) || (file.second <= processed->second))) { continue;}
+			auto it = seen.find(file.first);
+			if ((it == seen.end()) || (it->second.size != file.second)) {
+				seen[file.first] = Seen{file.second, now};
+				if (!once) { continue;}
+			}
+			// with --once, the files are supposed to be complete
+			bool ready = once || (std::chrono::duration<double>(now - seen[file.first].since).count() >= quiet);
+			if (ready) {
+				if (processed != done.end()) {
+					printf("dqd : %s has grown (%ld -> %ld bytes), processed again\n", file.first.c_str(), processed->second, file.second);
+				}
+				done[file.first] = file.second;
+				{
+					std::lock_guard<std::mutex> lock(queue_mutex);
+					queue.push_back(file);
+				}
+				cv_queue.notify_one();
+			}
+		}
+		if (once) { break;}
+		auto wake_up = std::chrono::steady_clock::now() + std::chrono::duration<double>(poll);
+		while (!stop_requested && (std::chrono::steady_clock::now() < wake_up)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		finished = true;
+	}
+	cv_queue.notify_all();
+	for (std::thread& job : jobs) {
+		job.join();
+	}
+	printf("dqd : %d files in %s\n", nlines, summary_name.c_str());
+}
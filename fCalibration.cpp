@@ -0,0 +1,123 @@
+/***********************************************
+ * Pedestal and noise of each wire (calibration)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fCalibration.h"
+#include "fChannelMap.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char magic[8] = {'f', 'C', 'A', 'L', 'I', 'B', '\0', '\0'};
+
+static_assert(sizeof(fCalibration::Entry) == 24, "fixed layout of the file");
+
+fCalibration::fCalibration(std::string tag, int npedestal) : entries(fChannelMap::nchannels, Entry{0, 0, 0, 0, 0, 0}) {
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.nchannels = fChannelMap::nchannels;
+	header.entry_size = sizeof(Entry);
+	header.npedestal = npedestal;
+	strncpy(header.tag, tag.c_str(), sizeof(header.tag) - 1);
+	table = entries.data();
+}
+
+fCalibration::~fCalibration() { unmap();}
+
+void fCalibration::unmap() {
+	if (mapping != nullptr) {
+		munmap(mapping, mapping_size);
+		mapping = nullptr;
+		mapping_size = 0;
+	}
+	table = entries.data();
+}
+
+void fCalibration::set_entry(int channel, const Entry& entry) {
+	unmap(); // back to the table being filled
+	entries[channel] = entry;
+}
+
+void fCalibration::set_nevents(long n) { header.nevents = n;}
+
+bool fCalibration::write(const std::string& filename) {
+	std::string tmpname = filename + ".tmp";
+	FILE* file = fopen(tmpname.c_str(), "wb");
+	if (file == NULL) {
+		perror("Error opening file\n");
+		return false;
+	}
+	bool ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+	ok = ok && (fwrite(table, sizeof(Entry), header.nchannels, file) == header.nchannels);
+	ok = (fclose(file) == 0) && ok;
+	if (!ok || (rename(tmpname.c_str(), filename.c_str()) != 0)) {
+		perror("Error writing file\n");
+		return false;
+	}
+	return true;
+}
+
+bool fCalibration::map(const std::string& filename) {
+	unmap();
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		perror("Error opening file\n");
+		return false;
+	}
+	struct stat info;
+	bool ok = (fstat(fd, &info) == 0) && (info.st_size >= (off_t) sizeof(Header));
+	void* data = ok ? mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd); // the mapping stays valid
+	ok = (data != MAP_FAILED);
+	if (ok) {
+		mapping = data;
+		mapping_size = info.st_size;
+		const Header* h = (const Header*) data;
+		ok = (memcmp(h->magic, magic, sizeof(magic)) == 0) && (h->version <= version)
+			&& (h->nchannels == (uint32_t) fChannelMap::nchannels) && (h->entry_size == sizeof(Entry))
+			&& (mapping_size == sizeof(Header) + h->nchannels*sizeof(Entry));
+	}
+	if (!ok) {
+		printf("%s is not a valid calibration table\n", filename.c_str());
+		unmap();
+		return false;
+	}
+	memcpy(&header, mapping, sizeof(header));
+	header.tag[sizeof(header.tag) - 1] = '\0';
+	table = (const Entry*) ((const char*) mapping + sizeof(Header));
+	return true;
+}
+
+const fCalibration::Entry& fCalibration::operator[](int channel) const { return table[channel];}
+bool fCalibration::has_data(int channel) const { return table[channel].nhits > 0;}
+int fCalibration::getNumberOfPedestalSamples() const { return header.npedestal;}
+long fCalibration::getNumberOfEvents() const { return header.nevents;}
+std::string fCalibration::getTag() const { return header.tag;}
+
+void fCalibration::getPedestals(const fWaveformBatch& batch, float* pedestals) const {
+	const int16_t* layers = batch.getLayers();
+	const int16_t* components = batch.getComponents();
+	const int16_t* first = batch.getSamples(0);
+	for (int hit = 0; hit < batch.getNumberOfHits(); hit++) {
+		int channel = fChannelMap::getChannel(layers[hit], components[hit]);
+		bool known = (channel >= 0) && (table[channel].nhits > 0);
+		pedestals[hit] = known ? table[channel].pedestal : first[hit];
+	}
+}
+
+std::string fCalibration::getDefaultName(std::string input) {
+	size_t slash = input.find_last_of('/');
+	std::string base = (slash == std::string::npos) ? input : input.substr(slash + 1);
+	size_t dot = base.find_last_of('.');
+	if ((dot != std::string::npos) && (dot > 0)) {
+		base = base.substr(0, dot);
+	}
+	return base + ".fcal";
+}
@@ -0,0 +1,84 @@
+/***********************************************
+ * Pedestal and noise of each wire (calibration)
+ *
+ * calib.exe computes, for each of the 576 channels
+ * (see fChannelMap), the mean and the spread of the
+ * pedestal, the mean RMS of the waveforms and the
+ * valid samples (before the trailing zeros). The
+ * table is saved in a small file of fixed layout
+ * (native byte order) :
+ *   - header : magic, version, number of channels,
+ *     size of an entry, number of samples of the
+ *     pedestal, number of events, tag
+ *   - one Entry (24 bytes) per channel, in the
+ *     order of fChannelMap
+ * The other tools map the file in memory (map) :
+ * no parsing, the entries are read in place.
+ *
+ * The pedestals of the hits of a batch are looked
+ * up by channel (getPedestals) and subtracted in
+ * one vectorized pass (fKernels::subtract_pedestals).
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_CALIBRATION_H
+#define F_CALIBRATION_H
+
+#include "fWaveformBatch.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class fCalibration {
+public :
+	struct Entry {
+		float pedestal; ///< mean of the first samples of the waveforms
+		float pedestal_sigma; ///< spread of the pedestal from one hit to another
+		float rms; ///< mean RMS of the waveforms (see fWaveformStats::getRms)
+		float length; ///< mean number of valid samples
+		uint32_t nhits; ///< 0 : no data for this wire
+		uint32_t ntruncated; ///< hits with trailing zeros (zero suppression)
+	};
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t nchannels; ///< fChannelMap::nchannels
+		uint32_t entry_size; ///< sizeof(Entry)
+		uint32_t npedestal; ///< samples averaged for the pedestal of a hit
+		uint64_t nevents;
+		char tag[64];
+	};
+
+	static const uint32_t version = 1;
+private :
+	Header header;
+	std::vector<Entry> entries; ///< table being filled (set_entry)
+	void* mapping = nullptr; ///< mapped file, nullptr if none
+	size_t mapping_size = 0;
+	const Entry* table; ///< entries or the entries of the mapped file
+	void unmap();
+public :
+	fCalibration(std::string tag = "", int npedestal = 5);
+	~fCalibration();
+	fCalibration(const fCalibration&) = delete;
+	fCalibration& operator=(const fCalibration&) = delete;
+	void set_entry(int channel, const Entry& entry);
+	void set_nevents(long n);
+	bool write(const std::string& filename); ///< written in filename.tmp then renamed
+	bool map(const std::string& filename); ///< read only, the header is checked
+	const Entry& operator[](int channel) const;
+	bool has_data(int channel) const; ///< at least one hit on this wire
+	int getNumberOfPedestalSamples() const;
+	long getNumberOfEvents() const;
+	std::string getTag() const;
+	/** pedestal of each hit of the batch, the first sample for a wire without data */
+	void getPedestals(const fWaveformBatch& batch, float* pedestals) const;
+	/** e.g path/run.hipo -> run.fcal (in the current directory) */
+	static std::string getDefaultName(std::string input);
+};
+
+#endif
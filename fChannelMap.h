@@ -0,0 +1,119 @@
+/***********************************************
+ * Channels of the AHDC
+ *
+ * The 576 wires of the 8 layers (layer code 11 to
+ * 51, component from 1) are numbered 0 to 575,
+ * layer after layer :
+ *
+ *   layer    11  21   22   31   32   41   42   51
+ *   wires    47  56   56   72   72   87   87   99
+ *   offset    0  47  103  159  231  303  390  477
+ *
+ * getChannel checks the range of the component :
+ * a component past the last wire of its layer is
+ * -1 (the former wire_number functions gave the
+ * first wires of the next layer, e.g (21, 57) ->
+ * 103, the wire (22, 1)).
+ *
+ * All the lookups are tables computed at compile
+ * time, an analysis loop indexes them instead of
+ * going through a chain of if/else on the layer
+ * code.
+ *
+ * fChannelArray<T> holds one T per channel
+ * (counters, sums...) in a contiguous array, the
+ * wires of a layer are contiguous too.
+ *
+ * e.g
+ *     fChannelArray<long> occupancy;
+ *     int channel = fChannelMap::getChannel(layer, component);
+ *     if (channel >= 0) { occupancy[channel]++;}
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_CHANNEL_MAP_H
+#define F_CHANNEL_MAP_H
+
+#include <array>
+#include <cstdint>
+
+/** layout of the layers, used to build the tables of fChannelMap */
+struct fChannelLayout {
+	static constexpr int nlayers = 8;
+	static constexpr int nchannels = 576;
+	static constexpr int max_layer_code = 63; ///< the layer codes are in [0, max_layer_code]
+	static constexpr std::array<int, nlayers> layer_codes = {11, 21, 22, 31, 32, 41, 42, 51};
+	static constexpr std::array<int, nlayers + 1> offsets = {0, 47, 103, 159, 231, 303, 390, 477, 576};
+
+	/** layer index of each layer code, -1 for the codes not used */
+	static constexpr std::array<int8_t, max_layer_code + 1> make_layer_table() {
+		std::array<int8_t, max_layer_code + 1> table = {};
+		for (int code = 0; code <= max_layer_code; code++) { table[code] = -1;}
+		for (int i = 0; i < nlayers; i++) { table[layer_codes[i]] = i;}
+		return table;
+	}
+
+	/** layer index of each channel */
+	static constexpr std::array<int8_t, nchannels> make_channel_table() {
+		std::array<int8_t, nchannels> table = {};
+		for (int i = 0; i < nlayers; i++) {
+			for (int channel = offsets[i]; channel < offsets[i + 1]; channel++) { table[channel] = i;}
+		}
+		return table;
+	}
+};
+
+class fChannelMap {
+public :
+	static constexpr int nlayers = fChannelLayout::nlayers;
+	static constexpr int nchannels = fChannelLayout::nchannels;
+	static constexpr int max_layer_code = fChannelLayout::max_layer_code;
+private :
+	static constexpr std::array<int, nlayers> layer_codes = fChannelLayout::layer_codes;
+	static constexpr std::array<int, nlayers + 1> offsets = fChannelLayout::offsets;
+	static constexpr std::array<int8_t, max_layer_code + 1> layer_table = fChannelLayout::make_layer_table();
+	static constexpr std::array<int8_t, nchannels> channel_table = fChannelLayout::make_channel_table();
+public :
+	/** 0 to 7 for the layers 11 to 51, -1 otherwise */
+	static constexpr int getLayerIndex(int layer) {
+		return ((layer >= 0) && (layer <= max_layer_code)) ? layer_table[layer] : -1;
+	}
+	static constexpr int getLayerCode(int index) { return layer_codes[index];}
+	static constexpr int getNumberOfWires(int index) { return offsets[index + 1] - offsets[index];}
+	static constexpr int getFirstChannel(int index) { return offsets[index];}
+
+	/** 0 to 575, -1 if the layer or the component does not exist */
+	static constexpr int getChannel(int layer, int component) {
+		int index = getLayerIndex(layer);
+		bool valid = (index >= 0) && (component >= 1) && (component <= offsets[index + 1] - offsets[index]);
+		return valid ? offsets[index] + component - 1 : -1;
+	}
+	static constexpr int getLayerIndexOfChannel(int channel) { return channel_table[channel];}
+	static constexpr int getLayerOfChannel(int channel) { return layer_codes[channel_table[channel]];}
+	static constexpr int getComponentOfChannel(int channel) { return channel - offsets[channel_table[channel]] + 1;}
+};
+
+static_assert(fChannelMap::getChannel(11, 1) == 0, "first wire");
+static_assert(fChannelMap::getChannel(51, 99) == fChannelMap::nchannels - 1, "last wire");
+static_assert(fChannelMap::getChannel(21, 57) == -1, "56 wires in the layer 21");
+static_assert(fChannelMap::getLayerOfChannel(477) == 51, "first wire of the layer 51");
+
+/** one T per channel, e.g counters or sums per wire */
+template <typename T>
+struct fChannelArray {
+	std::array<T, fChannelMap::nchannels> data = {};
+	T& operator[](int channel) { return data[channel];}
+	const T& operator[](int channel) const { return data[channel];}
+	T* getLayer(int index) { return data.data() + fChannelMap::getFirstChannel(index);} ///< the getNumberOfWires(index) wires of a layer
+	const T* getLayer(int index) const { return data.data() + fChannelMap::getFirstChannel(index);}
+	void merge(const fChannelArray& other) {
+		for (int channel = 0; channel < fChannelMap::nchannels; channel++) {
+			data[channel] += other.data[channel];
+		}
+	}
+	void clear() { data.fill(T());}
+};
+
+#endif
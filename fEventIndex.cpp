@@ -0,0 +1,97 @@
+/***********************************************
+ * Index of selected events (skim)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fEventIndex.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sys/stat.h>
+
+static const char magic[8] = {'f', 'E', 'V', 'T', 'I', 'D', 'X', '\0'};
+
+fEventIndex::fEventIndex(std::string _tag, int _nrecords) : tag(_tag), nrecords(_nrecords) {}
+
+void fEventIndex::add(const Entry& entry) { entries.push_back(entry);}
+
+void fEventIndex::add(int record, int index, long number) { entries.push_back(Entry{record, index, number});}
+
+void fEventIndex::sort() {
+	std::sort(entries.begin(), entries.end());
+	auto same = [] (const Entry& a, const Entry& b) { return (a.record == b.record) && (a.index == b.index);};
+	entries.erase(std::unique(entries.begin(), entries.end(), same), entries.end());
+}
+
+bool fEventIndex::write(const std::string& filename) {
+	sort();
+	std::string tmpname = filename + ".tmp";
+	FILE* file = fopen(tmpname.c_str(), "wb");
+	if (file == NULL) {
+		perror("Error opening file\n");
+		return false;
+	}
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.nrecords = nrecords;
+	header.nentries = entries.size();
+	strncpy(header.tag, tag.c_str(), sizeof(header.tag) - 1);
+	bool ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+	ok = ok && (fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size());
+	ok = (fclose(file) == 0) && ok;
+	if (!ok || (rename(tmpname.c_str(), filename.c_str()) != 0)) {
+		perror("Error writing file\n");
+		return false;
+	}
+	return true;
+}
+
+bool fEventIndex::read(const std::string& filename) {
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (file == NULL) {
+		perror("Error opening file\n");
+		return false;
+	}
+	Header header;
+	struct stat info;
+	bool ok = (fstat(fileno(file), &info) == 0);
+	ok = ok && (fread(&header, sizeof(header), 1, file) == 1) && (memcmp(header.magic, magic, sizeof(magic)) == 0) && (header.version <= version);
+	// the number of entries must match the size of the file (before any allocation)
+	uint64_t data_size = ok ? (uint64_t) info.st_size - sizeof(Header) : 0; // the header has been read
+	ok = ok && (data_size % sizeof(Entry) == 0) && (header.nentries == data_size/sizeof(Entry));
+	if (ok) {
+		header.tag[sizeof(header.tag) - 1] = '\0';
+		tag = header.tag;
+		nrecords = header.nrecords;
+		entries.resize(header.nentries);
+		ok = (fread(entries.data(), sizeof(Entry), entries.size(), file) == entries.size());
+	}
+	fclose(file);
+	if (!ok) {
+		printf("%s is not a valid event index\n", filename.c_str());
+		entries.clear();
+		return false;
+	}
+	std::sort(entries.begin(), entries.end());
+	return true;
+}
+
+int fEventIndex::size() const { return entries.size();}
+const fEventIndex::Entry& fEventIndex::operator[](int i) const { return entries[i];}
+const std::vector<fEventIndex::Entry>& fEventIndex::getEntries() const { return entries;}
+std::string fEventIndex::getTag() const { return tag;}
+int fEventIndex::getNumberOfRecords() const { return nrecords;}
+
+std::string fEventIndex::getSidecarName(std::string input, std::string tag, std::string suffix) {
+	size_t slash = input.find_last_of('/');
+	std::string base = (slash == std::string::npos) ? input : input.substr(slash + 1);
+	size_t dot = base.find_last_of('.');
+	if ((dot != std::string::npos) && (dot > 0)) {
+		base = base.substr(0, dot);
+	}
+	return base + "." + tag + suffix + ".fidx";
+}
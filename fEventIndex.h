@@ -0,0 +1,73 @@
+/***********************************************
+ * Index of selected events (skim)
+ *
+ * A selection (e.g the cosmics of hits.exe) is
+ * saved in a small sidecar file next to the
+ * output : for each event, the HIPO record that
+ * contains it, its position in the record and
+ * its number. Given to an executable with
+ * --index, only these records are read and only
+ * these events are processed (see fPipeline).
+ *
+ * The records and the event numbers are those of
+ * the whole file, also with --shard : the indexes
+ * of the shards of a file select disjoint records,
+ * they are merged by adding their entries to one
+ * fEventIndex (add, then write).
+ *
+ * Layout (native byte order) :
+ *   - header : magic, version, number of events,
+ *     number of records of the source file, tag
+ *   - one Entry (16 bytes) per event, sorted by
+ *     record and position
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_EVENT_INDEX_H
+#define F_EVENT_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class fEventIndex {
+public :
+	struct Entry {
+		int32_t record; ///< record of the HIPO file
+		int32_t index; ///< position of the event in the record
+		int64_t number; ///< event number given to the callback of fPipeline
+		bool operator<(const Entry& other) const { return (record < other.record) || ((record == other.record) && (index < other.index));}
+	};
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t nrecords; ///< number of records of the source file (to check the file given with the index)
+		uint64_t nentries;
+		char tag[64];
+	};
+
+	static const uint32_t version = 1;
+private :
+	std::string tag; ///< name of the selection
+	int nrecords; ///< of the source file, 0 if unknown
+	std::vector<Entry> entries;
+public :
+	fEventIndex(std::string _tag = "", int _nrecords = 0);
+	void add(const Entry& entry);
+	void add(int record, int index, long number);
+	void sort(); ///< by record and position, the duplicates are removed
+	bool write(const std::string& filename); ///< sorted, written in filename.tmp then renamed
+	bool read(const std::string& filename);
+	int size() const;
+	const Entry& operator[](int i) const;
+	const std::vector<Entry>& getEntries() const;
+	std::string getTag() const;
+	int getNumberOfRecords() const;
+	/** e.g run.hipo, cosmics, _shard0of2 -> run.cosmics_shard0of2.fidx (in the current directory) */
+	static std::string getSidecarName(std::string input, std::string tag, std::string suffix = "");
+};
+
+#endif
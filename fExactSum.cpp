@@ -0,0 +1,90 @@
+/***********************************************
+ * Exact accumulator for sums of doubles
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fExactSum.h"
+#include <cmath>
+
+static const int nlimbs = 70; ///< 2240 bits, enough for the whole exponent range of a double
+static const int bias = 1126; ///< the smallest subnormal is 2^-1074 = M*2^(-1126) with M a 53 bits integer
+static const int max_adds = 1 << 30; ///< each add puts less than 2^32 in a limb
+
+fExactSum::fExactSum() : nonfinite(0.0), nadd(0) {}
+
+/**
+ * x = M*2^(e - 53) with M an integer of 53 bits,
+ * M is shifted at the position e - 53 + bias and
+ * added to the (at most three) limbs it covers.
+ */
+void fExactSum::add(double x) {
+	if (x == 0) {return ;}
+	if (!std::isfinite(x)) { nonfinite += x; return ;}
+	if (limbs.empty()) { limbs.assign(nlimbs, 0);}
+	int e;
+	double m = std::frexp(x, &e);
+	int64_t M = std::ldexp(m, 53);
+	int64_t sign = (M < 0) ? -1 : 1;
+	int pos = e - 53 + bias;
+	unsigned __int128 v = (unsigned __int128) (M*sign) << (pos % 32);
+	int k = pos/32;
+	limbs[k]   += sign*(int64_t) (v & 0xffffffff);
+	limbs[k+1] += sign*(int64_t) ((v >> 32) & 0xffffffff);
+	limbs[k+2] += sign*(int64_t) (v >> 64);
+	if (++nadd >= max_adds) { normalize();}
+}
+
+void fExactSum::add(const fExactSum& other) {
+	nonfinite += other.nonfinite;
+	if (other.limbs.empty()) {return ;}
+	if (limbs.empty()) { limbs.assign(nlimbs, 0);}
+	// both operands are normalized first so that the limbs cannot overflow
+	normalize();
+	fExactSum tmp = other;
+	tmp.normalize();
+	for (int k = 0; k < nlimbs; k++) {
+		limbs[k] += tmp.limbs[k];
+	}
+	nadd = 2;
+}
+
+void fExactSum::normalize() {
+	if (limbs.empty()) {return ;}
+	for (int k = 0; k < nlimbs - 1; k++) {
+		int64_t carry = limbs[k] >> 32; // floor division by 2^32
+		limbs[k] -= carry*((int64_t) 1 << 32);
+		limbs[k+1] += carry;
+	}
+	nadd = 0;
+}
+
+/**
+ * The normalized form of a given exact sum is unique,
+ * so the conversion to double is reproducible.
+ */
+double fExactSum::value() const {
+	if (nonfinite != 0 || std::isnan(nonfinite)) { return nonfinite;}
+	if (limbs.empty()) { return 0.0;}
+	fExactSum tmp = *this;
+	tmp.normalize();
+	// convert to sign and magnitude, the last limb is then 0
+	double sign = 1.0;
+	if (tmp.limbs[nlimbs-1] < 0) {
+		sign = -1.0;
+		for (int k = 0; k < nlimbs; k++) { tmp.limbs[k] = -tmp.limbs[k];}
+		tmp.normalize();
+	}
+	double result = 0.0;
+	for (int k = nlimbs - 1; k >= 0; k--) {
+		result += std::ldexp((double) tmp.limbs[k], 32*k - bias);
+	}
+	return sign*result;
+}
+
+void fExactSum::reset() {
+	limbs.clear();
+	nonfinite = 0.0;
+	nadd = 0;
+}
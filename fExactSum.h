@@ -0,0 +1,34 @@
+/***********************************************
+ * Exact accumulator for sums of doubles
+ *
+ * The sum is kept as a long fixed-point integer
+ * so that the result does not depend on the order
+ * of the additions. Used by fH1D to reproduce the
+ * moments of a single-threaded run bit-for-bit
+ * after merging per-thread histograms.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_EXACT_SUM_H
+#define F_EXACT_SUM_H
+
+#include <vector>
+#include <cstdint>
+
+class fExactSum {
+private :
+	std::vector<int64_t> limbs; ///< 32 bits per limb, least significant first (allocated at the first add)
+	double nonfinite; ///< sum of the inf and nan values
+	int nadd; ///< number of additions since the last carry propagation
+	void normalize(); ///< propagate the carries, each limb except the last one ends in [0, 2^32[
+public :
+	fExactSum();
+	void add(double x);
+	void add(const fExactSum& other);
+	double value() const;
+	void reset();
+};
+
+#endif
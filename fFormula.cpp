@@ -0,0 +1,261 @@
+/***********************************************
+ * Arithmetic expression over the columns of a
+ * bank
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fFormula.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+// types of the hipo schema
+static const int type_byte = 1;
+static const int type_short = 2;
+static const int type_int = 3;
+static const int type_float = 4;
+static const int type_double = 5;
+static const int type_long = 8;
+
+fFormula::fFormula(std::string _text) : text(_text) {
+	skip_spaces();
+	if (pos == text.size()) { return ;} // empty formula
+	parse_or();
+	skip_spaces();
+	if (error.empty() && (pos != text.size())) {
+		error = "unexpected '" + text.substr(pos) + "'";
+	}
+	if (!error.empty()) {
+		program.clear();
+		return ;
+	}
+	// stack size
+	int size = 0;
+	for (const Instruction& ins : program) {
+		if ((ins.op == FORMULA_CONST) || (ins.op == FORMULA_COLUMN)) { size++;}
+		else if ((ins.op != FORMULA_NEG) && (ins.op != FORMULA_NOT)) { size--;}
+		depth = (size > depth) ? size : depth;
+	}
+}
+
+void fFormula::skip_spaces() {
+	while ((pos < text.size()) && isspace((unsigned char) text[pos])) { pos++;}
+}
+
+/** the token is consumed if it is the next one */
+bool fFormula::accept(const char* token) {
+	skip_spaces();
+	size_t n = strlen(token);
+	if (text.compare(pos, n, token) != 0) { return false;}
+	// "<" must not match "<=", "!" must not match "!="
+	if ((n == 1) && (pos + 1 < text.size()) && (text[pos + 1] == '=') && strchr("<>!=", token[0])) { return false;}
+	pos += n;
+	return true;
+}
+
+void fFormula::emit(fFormulaOp op, double value, int column) {
+	program.push_back(Instruction{op, value, column});
+}
+
+void fFormula::parse_or() {
+	parse_and();
+	while (error.empty() && accept("||")) {
+		parse_and();
+		emit(FORMULA_OR);
+	}
+}
+
+void fFormula::parse_and() {
+	parse_comparison();
+	while (error.empty() && accept("&&")) {
+		parse_comparison();
+		emit(FORMULA_AND);
+	}
+}
+
+void fFormula::parse_comparison() {
+	parse_sum();
+	while (error.empty()) {
+		fFormulaOp op;
+		if      (accept("==")) { op = FORMULA_EQ;}
+		else if (accept("!=")) { op = FORMULA_NE;}
+		else if (accept("<=")) { op = FORMULA_LE;}
+		else if (accept(">=")) { op = FORMULA_GE;}
+		else if (accept("<"))  { op = FORMULA_LT;}
+		else if (accept(">"))  { op = FORMULA_GT;}
+		else { return ;}
+		parse_sum();
+		emit(op);
+	}
+}
+
+void fFormula::parse_sum() {
+	parse_product();
+	while (error.empty()) {
+		fFormulaOp op;
+		if      (accept("+")) { op = FORMULA_ADD;}
+		else if (accept("-")) { op = FORMULA_SUB;}
+		else { return ;}
+		parse_product();
+		emit(op);
+	}
+}
+
+void fFormula::parse_product() {
+	parse_unary();
+	while (error.empty()) {
+		fFormulaOp op;
+		if      (accept("*")) { op = FORMULA_MUL;}
+		else if (accept("/")) { op = FORMULA_DIV;}
+		else { return ;}
+		parse_unary();
+		emit(op);
+	}
+}
+
+void fFormula::parse_unary() {
+	if (accept("-")) {
+		parse_unary();
+		emit(FORMULA_NEG);
+	}
+	else if (accept("!")) {
+		parse_unary();
+		emit(FORMULA_NOT);
+	}
+	else {
+		parse_primary();
+	}
+}
+
+void fFormula::parse_primary() {
+	skip_spaces();
+	if (pos == text.size()) {
+		error = "unexpected end of \"" + text + "\"";
+		return ;
+	}
+	char c = text[pos];
+	if (accept("(")) {
+		parse_or();
+		if (error.empty() && !accept(")")) {
+			error = "missing ')' in \"" + text + "\"";
+		}
+	}
+	else if (isdigit((unsigned char) c) || (c == '.')) {
+		const char* begin = text.c_str() + pos;
+		char* end;
+		double value = strtod(begin, &end);
+		pos += end - begin;
+		emit(FORMULA_CONST, value);
+	}
+	else if (isalpha((unsigned char) c) || (c == '_')) {
+		size_t begin = pos;
+		while ((pos < text.size()) && (isalnum((unsigned char) text[pos]) || (text[pos] == '_'))) { pos++;}
+		std::string name = text.substr(begin, pos - begin);
+		int column = 0;
+		while ((column < (int) columns.size()) && (columns[column] != name)) { column++;}
+		if (column == (int) columns.size()) { columns.push_back(name);}
+		emit(FORMULA_COLUMN, 0, column);
+	}
+	else {
+		error = "unexpected '" + text.substr(pos) + "'";
+	}
+}
+
+bool fFormula::is_valid() const { return error.empty();}
+bool fFormula::is_empty() const { return program.empty() && error.empty();}
+std::string fFormula::getText() const { return text;}
+std::string fFormula::getError() const { return error;}
+const std::vector<std::string>& fFormula::getColumns() const { return columns;}
+const std::vector<fFormula::Instruction>& fFormula::getProgram() const { return program;}
+
+bool fFormula::compile(hipo::schema& schema) {
+	items.clear();
+	types.clear();
+	for (const std::string& name : columns) {
+		int item = schema.getEntryOrder(name.c_str());
+		if (item < 0) {
+			error = "no column " + name;
+			return false;
+		}
+		items.push_back(item);
+		types.push_back(schema.getEntryType(item));
+	}
+	stack.resize(depth);
+	return true;
+}
+
+/** the type is chosen once per column, not per row */
+void fFormula::load(hipo::bank& bank, int column, double* x, int nrows) const {
+	int item = items[column];
+	switch (types[column]) {
+		case type_byte :
+			for (int row = 0; row < nrows; row++) { x[row] = bank.getByte(item, row);}
+			break;
+		case type_short :
+			for (int row = 0; row < nrows; row++) { x[row] = bank.getShort(item, row);}
+			break;
+		case type_float :
+			for (int row = 0; row < nrows; row++) { x[row] = bank.getFloat(item, row);}
+			break;
+		case type_double :
+			for (int row = 0; row < nrows; row++) { x[row] = bank.getDouble(item, row);}
+			break;
+		case type_long :
+			for (int row = 0; row < nrows; row++) { x[row] = bank.getLong(item, row);}
+			break;
+		case type_int :
+		default :
+			for (int row = 0; row < nrows; row++) { x[row] = bank.getInt(item, row);}
+			break;
+	}
+}
+
+/**
+ * Each instruction is applied to all the rows :
+ * stack[k] holds the values of the level k of the
+ * stack for all the rows
+ */
+void fFormula::evaluate(hipo::bank& bank, std::vector<double>& values) {
+	int nrows = bank.getRows();
+	values.resize(nrows);
+	if (program.empty() || (nrows == 0)) { return ;}
+	int top = -1; // level of the top of the stack
+	for (const Instruction& ins : program) {
+		if ((ins.op == FORMULA_CONST) || (ins.op == FORMULA_COLUMN)) {
+			top++;
+			stack[top].resize(nrows);
+			double* x = stack[top].data();
+			if (ins.op == FORMULA_CONST) {
+				for (int row = 0; row < nrows; row++) { x[row] = ins.value;}
+			}
+			else {
+				load(bank, ins.column, x, nrows);
+			}
+			continue;
+		}
+		double* a = stack[(ins.op == FORMULA_NEG) || (ins.op == FORMULA_NOT) ? top : top - 1].data();
+		const double* b = stack[top].data();
+		switch (ins.op) {
+			case FORMULA_NEG : for (int i = 0; i < nrows; i++) { a[i] = -a[i];} break;
+			case FORMULA_NOT : for (int i = 0; i < nrows; i++) { a[i] = (a[i] == 0);} break;
+			case FORMULA_ADD : for (int i = 0; i < nrows; i++) { a[i] = a[i] + b[i];} break;
+			case FORMULA_SUB : for (int i = 0; i < nrows; i++) { a[i] = a[i] - b[i];} break;
+			case FORMULA_MUL : for (int i = 0; i < nrows; i++) { a[i] = a[i] * b[i];} break;
+			case FORMULA_DIV : for (int i = 0; i < nrows; i++) { a[i] = a[i] / b[i];} break;
+			case FORMULA_EQ  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] == b[i]);} break;
+			case FORMULA_NE  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] != b[i]);} break;
+			case FORMULA_LT  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] < b[i]);} break;
+			case FORMULA_LE  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] <= b[i]);} break;
+			case FORMULA_GT  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] > b[i]);} break;
+			case FORMULA_GE  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] >= b[i]);} break;
+			case FORMULA_AND : for (int i = 0; i < nrows; i++) { a[i] = (a[i] != 0) & (b[i] != 0);} break;
+			case FORMULA_OR  : for (int i = 0; i < nrows; i++) { a[i] = (a[i] != 0) | (b[i] != 0);} break;
+			default : break;
+		}
+		if ((ins.op != FORMULA_NEG) && (ins.op != FORMULA_NOT)) { top--;}
+	}
+	values.swap(stack[0]);
+}
@@ -0,0 +1,95 @@
+/***********************************************
+ * Arithmetic expression over the columns of a
+ * bank, e.g
+ *     leadingEdgeTime/50
+ *     layer == 51 && ADC > 200
+ *
+ * Numbers, column names, parentheses and the
+ * operators (by increasing precedence)
+ *     ||    &&    == != < <= > >=    + -    * /
+ *     unary - and !
+ * A comparison or a logical operator gives 1 or 0,
+ * a value different from 0 is true.
+ *
+ * The text is parsed once in a postfix program.
+ * compile() resolves the columns and their types
+ * in the schema of the bank, evaluate() then runs
+ * the program one instruction at a time on all the
+ * rows of the bank (no parsing or search by name
+ * per row, simple loops over arrays).
+ *
+ * A fFormula keeps its work arrays : use one copy
+ * per thread.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_FORMULA_H
+#define F_FORMULA_H
+
+#include "reader.h"
+#include <string>
+#include <vector>
+
+enum fFormulaOp {
+	FORMULA_CONST, ///< push value
+	FORMULA_COLUMN, ///< push the column item
+	FORMULA_NEG,
+	FORMULA_NOT,
+	FORMULA_ADD,
+	FORMULA_SUB,
+	FORMULA_MUL,
+	FORMULA_DIV,
+	FORMULA_EQ,
+	FORMULA_NE,
+	FORMULA_LT,
+	FORMULA_LE,
+	FORMULA_GT,
+	FORMULA_GE,
+	FORMULA_AND,
+	FORMULA_OR
+};
+
+class fFormula {
+public :
+	struct Instruction {
+		fFormulaOp op;
+		double value; ///< FORMULA_CONST
+		int column; ///< FORMULA_COLUMN : position in getColumns()
+	};
+private :
+	std::string text;
+	std::vector<Instruction> program; ///< postfix
+	std::vector<std::string> columns; ///< names of the columns used
+	std::vector<int> items; ///< column numbers in the bank (see compile)
+	std::vector<int> types; ///< hipo types of the columns
+	int depth = 0; ///< size of the stack needed by the program
+	std::string error; ///< empty if the text is valid
+	std::vector<std::vector<double>> stack; ///< work arrays, one per level
+	// recursive descent parser, pos is the position in text
+	size_t pos = 0;
+	void skip_spaces();
+	bool accept(const char* token);
+	void parse_or();
+	void parse_and();
+	void parse_comparison();
+	void parse_sum();
+	void parse_product();
+	void parse_unary();
+	void parse_primary();
+	void emit(fFormulaOp op, double value = 0, int column = -1);
+	void load(hipo::bank& bank, int column, double* x, int nrows) const;
+public :
+	fFormula(std::string _text = ""); ///< parse the text, see getError
+	bool is_valid() const;
+	bool is_empty() const; ///< no text
+	std::string getText() const;
+	std::string getError() const;
+	const std::vector<std::string>& getColumns() const;
+	const std::vector<Instruction>& getProgram() const;
+	bool compile(hipo::schema& schema); ///< resolve the columns, false if one of them is missing
+	void evaluate(hipo::bank& bank, std::vector<double>& values); ///< one value per row
+};
+
+#endif
@@ -13,31 +13,94 @@
 #include <cmath>
 #include <cstdlib>
 #include <functional>
+#include <algorithm>
 
-fH1D::fH1D(std::string _title, int _nbins, double _xmin, double _xmax) : title(_title), nbins(_nbins), xmin(_xmin), xmax(_xmax) {
-	if (xmax < xmin) {
-		printf("Histogram parameters are incorrects : xmax < xmin");		
+/**
+ * Uniform binning, or logarithmic binning if logbins is true
+ * (bins of the same width in log(x), xmin must then be > 0)
+ */
+fH1D::fH1D(std::string _title, int _nbins, double _xmin, double _xmax, bool logbins) : title(_title), nbins(_nbins), xmin(_xmin), xmax(_xmax) {
+	binning = BINNING_UNIFORM;
+	if (!(xmin <= xmax) || (nbins < 1)) { // also nan
+		printf("Histogram parameters are incorrects : xmax < xmin or nbins < 1\n");
+		nbins = 0; // no bin : set_bin_content and fill never index the buffer
+		init();
 		return ;
 	}
-	binw = (xmax - xmin)/nbins;
-	for (int i = 0; i < nbins; i++) {
-		binArray.push_back(xmin + i*binw + 0.5*binw);
-		binBuffer.push_back(0.0);
+	if (logbins) {
+		if (xmin <= 0) {
+			printf("Histogram parameters are incorrects : xmin <= 0 with a logarithmic binning, uniform binning used\n");
+		}
+		else {
+			binning = BINNING_LOG;
+			double logw = std::log2(xmax/xmin)/nbins;
+			inv_logw = 1.0/logw;
+			for (int i = 0; i <= nbins; i++) {
+				edges.push_back(xmin*std::exp2(i*logw));
+			}
+			edges[0] = xmin;
+			edges[nbins] = xmax;
+		}
 	}
+	init();
+}
+
+/**
+ * Variable binning
+ *
+ * @param _edges increasing list of the nbins+1 bin edges
+ */
+fH1D::fH1D(std::string _title, std::vector<double> _edges) : title(_title), nbins(0), xmin(0), xmax(0) {
+	binning = BINNING_UNIFORM;
+	if (_edges.size() < 2) {
+		printf("Histogram parameters are incorrects : at least two bin edges are needed\n");
+		init(); // no bin
+		return ;
+	}
+	for (int i = 1; i < (int) _edges.size(); i++) {
+		if (!(_edges[i] > _edges[i-1])) {
+			printf("Histogram parameters are incorrects : bin edges are not increasing\n");
+			init();
+			return ;
+		}
+	}
+	edges = _edges;
+	nbins = edges.size() - 1;
+	xmin = edges.front();
+	xmax = edges.back();
+	binning = BINNING_VARIABLE;
+	init();
+}
+
+void fH1D::init() {
+	binw = (xmax - xmin)/nbins;
+	inv_binw = nbins/(xmax - xmin);
+	binBuffer.assign(nbins, 0.0);
 	underflow = 0;
 	overflow = 0;
 	nEntries = 0;
+	sumw = 0;
 	sum = 0;
 	sum2 = 0;
+	lut_min = 0;
 }
 
 void fH1D::fill(double x) {
+	if (autorange_size > 0) { buffer_entries(&x, nullptr, 1); return ;}
 	int bin = getBinNumber(x);
 	if (bin == -1) { underflow++; return;}
 	if (bin == -11) { overflow++; return;}
 	nEntries++;
-	binBuffer.at(bin) = binBuffer.at(bin) + 1.0;
+	binBuffer[bin] += 1.0;
+	if (pyramid_enabled) { update_pyramid_bin(bin);}
+	if (quantiles_enabled) { quantiles.add(x);}
 	// stats
+	if (deterministic) {
+		exact_sumw.add(1.0);
+		exact_sum.add(x);
+		exact_sum2.add(x*x);
+		return ;
+	}
 	sumw += 1;
 	sum += x;
 	sum2 += x*x;
@@ -51,31 +114,226 @@ void fH1D::fill(double x) {
  * @note return -1 if undeflow and -11 if overflow
  */
 void fH1D::fill(double x, double w) {
+	if (autorange_size > 0) { buffer_entries(&x, &w, 1); return ;}
 	int bin = getBinNumber(x);
 	if (bin == -1) { underflow++; return ;}
 	if (bin == -11) { overflow++; return ;}
 	nEntries++;
-	binBuffer.at(bin) = binBuffer.at(bin) + w;
+	binBuffer[bin] += w;
+	if (pyramid_enabled) { update_pyramid_bin(bin);}
+	if (quantiles_enabled) { quantiles.add(x, w);}
 	//stats
+	if (deterministic) {
+		exact_sumw.add(w);
+		exact_sum.add(w*x);
+		exact_sum2.add(w*x*x);
+		return ;
+	}
 	sumw += w;
 	sum += w*x;
 	sum2 += w*x*x;
 }
 /**
+ * Uniform bins : the bin number is obtained arithmetically.
+ * Logarithmic bins : the bin number is obtained from log2(x)
+ * and corrected by one if x is on the wrong side of an edge.
+ * Variable bins : binary search in the bin edges.
  *
  * @note numerotation starts at 0
+ * @note return -1 if underflow (or nan) and -11 if overflow
  */
 int fH1D::getBinNumber(double x) const {
-	if (x < xmin) {return -1;}
-	if (x > xmax) {return -11;}
-	for (int i = 0; i < nbins; i++) {
-		double xinf = xmin + i*binw;
-		double xsup = xinf + binw;
-		if ((x >= xinf) && (x < xsup)) {
-			return i;
+	if (!(x >= xmin)) {return -1;}
+	if (x >= xmax) {return -11;}
+	if (binning == BINNING_UNIFORM) {
+		int bin = (x - xmin)*inv_binw;
+		return (bin < nbins) ? bin : nbins - 1; // rounding just below xmax
+	}
+	if (binning == BINNING_LOG) {
+		int bin = std::log2(x/xmin)*inv_logw;
+		bin = (bin < nbins) ? bin : nbins - 1;
+		bin -= (x < edges[bin]);
+		bin += (x >= edges[bin+1]);
+		return bin;
+	}
+	return searchEdges(x);
+}
+
+/**
+ * Binary search without branches in the loop (the
+ * comparison is compiled to a conditional move)
+ *
+ * @return i such that edges[i] <= x < edges[i+1]
+ */
+int fH1D::searchEdges(double x) const {
+	const double* e = edges.data();
+	int lo = 0;
+	int len = nbins + 1;
+	while (len > 1) {
+		int half = len/2;
+		lo = (e[lo + half] <= x) ? lo + half : lo;
+		len -= half;
+	}
+	return lo;
+}
+
+/**
+ * fill n values with a weight of 1
+ *
+ * The bin numbers of a chunk of values are computed
+ * first in a loop without branches that the compiler
+ * vectorizes, then the contents and the moments are
+ * accumulated.
+ */
+void fH1D::fill_batch(const double* x, int n) {
+	fill_batch(x, nullptr, n);
+}
+
+void fH1D::fill_batch(const std::vector<double>& x) {
+	fill_batch(x.data(), nullptr, x.size());
+}
+
+/**
+ * fill n values x[i] with weights w[i]
+ *
+ * @note w == nullptr means a weight of 1 for all values
+ */
+void fH1D::fill_batch(const double* x, const double* w, int n) {
+	if (autorange_size > 0) {
+		int m = buffer_entries(x, w, n);
+		x += m;
+		w = (w == nullptr) ? nullptr : w + m;
+		n -= m;
+	}
+	const int chunk = 256;
+	int bins[chunk];
+	for (int start = 0; start < n; start += chunk) {
+		int m = std::min(chunk, n - start);
+		const double* xc = x + start;
+		const double* wc = (w == nullptr) ? nullptr : w + start;
+		// bin numbers : -1 for underflow, nbins for overflow
+		if (binning != BINNING_UNIFORM) {
+			for (int i = 0; i < m; i++) {
+				int bin = getBinNumber(xc[i]);
+				bins[i] = (bin == -11) ? nbins : bin;
+			}
+			accumulate(xc, wc, bins, m);
+			continue;
+		}
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			double t = (xc[i] - xmin)*inv_binw;
+			t = (t > 0) ? t : 0; // also catches nan
+			t = (t < nbins - 1) ? t : nbins - 1;
+			int bin = t;
+			bin = (xc[i] >= xmin) ? bin : -1;
+			bin = (xc[i] < xmax) ? bin : nbins;
+			bins[i] = bin;
 		}
+		accumulate(xc, wc, bins, m);
 	}
-	return -1;
+}
+
+/**
+ * fill n integer values (e.g ADC samples) x[i] with weights w[i]
+ *
+ * The bin number of each integer is read from a lookup table
+ * built at the first call.
+ *
+ * @note w == nullptr means a weight of 1 for all values
+ */
+void fH1D::fill_batch(const int16_t* x, int n, const double* w) {
+	for (; (autorange_size > 0) && (n > 0); x++, n--) {
+		fill((double) x[0], (w == nullptr) ? 1.0 : *w++);
+	}
+	if (lut.empty()) { build_lut();}
+	const int chunk = 256;
+	int bins[chunk];
+	double values[chunk];
+	const int lut_size = lut.size();
+	for (int start = 0; start < n; start += chunk) {
+		int m = std::min(chunk, n - start);
+		const int16_t* xc = x + start;
+		const double* wc = (w == nullptr) ? nullptr : w + start;
+		for (int i = 0; i < m; i++) {
+			int k = xc[i] - lut_min;
+			int outside = (k < 0) ? -1 : nbins;
+			bins[i] = ((k >= 0) && (k < lut_size)) ? lut[k] : outside;
+			values[i] = xc[i];
+		}
+		accumulate(values, wc, bins, m);
+	}
+}
+
+/**
+ * Build the table giving the bin number of all the integers
+ * (in the range of int16_t) that can fall in [xmin, xmax[
+ */
+void fH1D::build_lut() {
+	int lo = std::max(std::floor(xmin), (double) INT16_MIN);
+	int hi = std::min(std::ceil(xmax), (double) INT16_MAX);
+	lut_min = lo;
+	lut.assign(std::max(hi - lo + 1, 0), nbins);
+	for (int v = lo; v <= hi; v++) {
+		int bin = getBinNumber(v);
+		lut[v - lo] = (bin == -1) ? -1 : ((bin == -11) ? nbins : bin);
+	}
+}
+
+/**
+ * Add a chunk of values whose bin numbers are already known
+ *
+ * @param bins bin numbers, -1 for underflow and nbins for overflow
+ */
+void fH1D::accumulate(const double* x, const double* w, const int* bins, int m) {
+	if (pyramid_enabled) {
+		int lo = nbins, hi = 0;
+		for (int i = 0; i < m; i++) {
+			if ((unsigned) bins[i] < (unsigned) nbins) {
+				lo = std::min(lo, bins[i]);
+				hi = std::max(hi, bins[i] + 1);
+			}
+		}
+		mark_dirty(lo, hi);
+	}
+	if (quantiles_enabled) {
+		for (int i = 0; i < m; i++) {
+			if ((unsigned) bins[i] < (unsigned) nbins) { quantiles.add(x[i], (w == nullptr) ? 1.0 : w[i]);}
+		}
+	}
+	if (deterministic) {
+		for (int i = 0; i < m; i++) {
+			if (bins[i] < 0) { underflow++;}
+			else if (bins[i] >= nbins) { overflow++;}
+			else {
+				double wi = (w == nullptr) ? 1.0 : w[i];
+				binBuffer[bins[i]] += wi;
+				exact_sumw.add(wi);
+				exact_sum.add(wi*x[i]);
+				exact_sum2.add(wi*x[i]*x[i]);
+				nEntries++;
+			}
+		}
+		return ;
+	}
+	double* content = binBuffer.data();
+	double s0 = 0, s1 = 0, s2 = 0;
+	for (int i = 0; i < m; i++) {
+		int bin = bins[i];
+		if ((unsigned) bin < (unsigned) nbins) {
+			double wi = (w == nullptr) ? 1.0 : w[i];
+			content[bin] += wi;
+			s0 += wi;
+			s1 += wi*x[i];
+			s2 += wi*x[i]*x[i];
+			nEntries++;
+		}
+		else if (bin < 0) { underflow++;}
+		else { overflow++;}
+	}
+	sumw += s0;
+	sum += s1;
+	sum2 += s2;
 }
 
 double fH1D::getBinBufferContent(int bin) const {
@@ -85,45 +343,430 @@ double fH1D::getBinBufferContent(int bin) const {
 	return binBuffer.at(bin);
 }
 
+/**
+ * @return the center of the bin (computed, not stored)
+ */
 double fH1D::getBinArrayContent(int bin) const {
 	/*if ((bin < 0) || (bin >= nbins)) {
 		return 0;
 	}*/
-	return binArray.at(bin);
+	return 0.5*(getBinLowEdge(bin) + getBinUpEdge(bin));
 }
 
 unsigned long int fH1D::getEntries() const { return nEntries;}
-double fH1D::getMean() const { return sum/sumw;}
-double fH1D::getStDev() const { return sqrt(sum2/sumw - getMean()*getMean());}
+unsigned long int fH1D::getUnderflow() const { return underflow;}
+unsigned long int fH1D::getOverflow() const { return overflow;}
+double fH1D::getSumOfWeights() const { return deterministic ? exact_sumw.value() : sumw;}
+double fH1D::getSum() const { return deterministic ? exact_sum.value() : sum;}
+double fH1D::getSum2() const { return deterministic ? exact_sum2.value() : sum2;}
+double fH1D::getXmin() const { return xmin;}
+double fH1D::getXmax() const { return xmax;}
+std::string fH1D::getTitle() const { return title;}
+std::string fH1D::getXtitle() const { return xtitle;}
+std::string fH1D::getYtitle() const { return ytitle;}
+const std::vector<double>& fH1D::getEdges() const { return edges;}
+double fH1D::getMean() const {
+	if (deterministic) { return exact_sum.value()/exact_sumw.value();}
+	return sum/sumw;
+}
+double fH1D::getStDev() const {
+	double mean = getMean();
+	double s2 = deterministic ? exact_sum2.value() : sum2;
+	return sqrt(s2/getSumOfWeights() - mean*mean);
+}
 double fH1D::getBinWidth() const {return binw;}
+double fH1D::getBinWidth(int bin) const {return getBinUpEdge(bin) - getBinLowEdge(bin);}
+double fH1D::getBinLowEdge(int bin) const {return edges.empty() ? xmin + bin*binw : edges[bin];}
+double fH1D::getBinUpEdge(int bin) const {return edges.empty() ? xmin + (bin + 1)*binw : edges[bin+1];}
+fBinning fH1D::getBinning() const {return binning;}
 int fH1D::getNumberOfBins() const {return nbins;}
-std::vector<double> fH1D::getBinArray() const {return binArray;}
+std::vector<double> fH1D::getBinArray() const {
+	std::vector<double> centers(nbins);
+	for (int i = 0; i < nbins; i++) {
+		centers[i] = getBinArrayContent(i);
+	}
+	return centers;
+}
 std::vector<double> fH1D::getBinBuffer() const {return binBuffer;}
 void fH1D::set_xtitle(std::string name) {xtitle = name;}
+void fH1D::set_bin_content(int bin, double content) {
+	if ((bin < 0) || (bin >= nbins)) {return ;}
+	binBuffer[bin] = content;
+	mark_dirty(bin, bin + 1);
+}
 void fH1D::set_ytitle(std::string name) {ytitle = name;}
 
 double fH1D::getMax() const {
-	int vmax = 0;
+	if (pyramid_enabled) { return std::max(getRangeStats(0, nbins).max, 0.0);}
+	double vmax = 0;
 	for (int i = 0; i < nbins; i++) {
-		vmax = (vmax < binBuffer.at(i)) ? binBuffer.at(i) : vmax;
+		vmax = (vmax < binBuffer[i]) ? binBuffer[i] : vmax;
 	}
 	return vmax;
 }
 
+/**
+ * Keep a pyramid of (min, max, sum) : level k+1 summarizes
+ * the bins by groups of 2^(k+1). A single fill updates the
+ * nodes above its bin, a batch fill only marks its bins and
+ * the nodes are updated when they are read. The statistics
+ * of any range of bins then cost O(log(nbins)).
+ */
+void fH1D::enable_pyramid() {
+	if (pyramid_enabled) {return ;}
+	pyramid_enabled = true;
+	pyramid.clear();
+	for (int size = (nbins + 1)/2; nbins > 1; size = (size + 1)/2) {
+		pyramid.push_back(std::vector<fPyramidNode>(size));
+		if (size == 1) {break;}
+	}
+	dirty_lo = 0;
+	dirty_hi = nbins;
+	update_pyramid();
+}
+
+fPyramidNode fH1D::getNode(int level, int j) const {
+	if (level == 0) { return fPyramidNode{binBuffer[j], binBuffer[j], binBuffer[j]};}
+	return pyramid[level-1][j];
+}
+
+void fH1D::mark_dirty(int lo, int hi) {
+	if (!pyramid_enabled || (lo >= hi)) {return ;}
+	if (dirty_lo >= dirty_hi) {
+		dirty_lo = lo;
+		dirty_hi = hi;
+		return ;
+	}
+	dirty_lo = std::min(dirty_lo, lo);
+	dirty_hi = std::max(dirty_hi, hi);
+}
+
+void fH1D::update_pyramid_bin(int bin) {
+	if (dirty_lo < dirty_hi) { mark_dirty(bin, bin + 1); return ;} // will be done with the others
+	int j = bin;
+	for (int level = 1; level <= (int) pyramid.size(); level++) {
+		j /= 2;
+		int nchildren = (level == 1) ? nbins : pyramid[level-2].size();
+		fPyramidNode node = getNode(level - 1, 2*j);
+		if (2*j + 1 < nchildren) {
+			fPyramidNode right = getNode(level - 1, 2*j + 1);
+			node.min = std::min(node.min, right.min);
+			node.max = std::max(node.max, right.max);
+			node.sum += right.sum;
+		}
+		pyramid[level-1][j] = node;
+	}
+}
+
+void fH1D::update_pyramid() const {
+	if (dirty_lo >= dirty_hi) {return ;}
+	int lo = dirty_lo, hi = dirty_hi - 1; // nodes to update, included
+	for (int level = 1; level <= (int) pyramid.size(); level++) {
+		lo /= 2;
+		hi /= 2;
+		int nchildren = (level == 1) ? nbins : pyramid[level-2].size();
+		for (int j = lo; j <= hi; j++) {
+			fPyramidNode node = getNode(level - 1, 2*j);
+			if (2*j + 1 < nchildren) {
+				fPyramidNode right = getNode(level - 1, 2*j + 1);
+				node.min = std::min(node.min, right.min);
+				node.max = std::max(node.max, right.max);
+				node.sum += right.sum;
+			}
+			pyramid[level-1][j] = node;
+		}
+	}
+	dirty_lo = dirty_hi = 0;
+}
+
+/**
+ * @note O(log(nbins)) with the pyramid, O(last - first) without
+ */
+fPyramidNode fH1D::getRangeStats(int first, int last) const {
+	first = std::max(first, 0);
+	last = std::min(last, nbins);
+	fPyramidNode result = {0, 0, 0};
+	if (first >= last) { return result;}
+	result = {binBuffer[first], binBuffer[first], 0};
+	auto add = [&result] (const fPyramidNode& node) {
+		result.min = std::min(result.min, node.min);
+		result.max = std::max(result.max, node.max);
+		result.sum += node.sum;
+	};
+	if (!pyramid_enabled) {
+		for (int i = first; i < last; i++) { add(getNode(0, i));}
+		return result;
+	}
+	update_pyramid();
+	int level = 0;
+	while ((first < last) && (level <= (int) pyramid.size())) {
+		if (first & 1) { add(getNode(level, first)); first++;}
+		if (last & 1) { last--; add(getNode(level, last));}
+		first /= 2;
+		last /= 2;
+		level++;
+	}
+	return result;
+}
+
+void fH1D::set_view(double x0, double x1) {
+	if (!(x1 > x0)) {return ;}
+	view_set = true;
+	view_xmin = std::max(x0, xmin);
+	view_xmax = std::min(x1, xmax);
+}
+
+void fH1D::reset_view() { view_set = false;}
+
 
 void fH1D::reset() {
-	if (binArray.size() < 1) {return ;}
+	if (nbins < 1) {return ;}
 	for (int i = 0; i < nbins; i++) {
                 binBuffer.at(i) = 0.0;
         }
         underflow = 0;
         overflow = 0;
         nEntries = 0;
+        sumw = 0;
         sum = 0;
         sum2 = 0;	
+        exact_sumw.reset();
+        exact_sum.reset();
+        exact_sum2.reset();
+        quantiles.reset();
+        autorange_x.clear();
+        autorange_w.clear();
+        mark_dirty(0, nbins);
+}
+
+/**
+ * Accumulate the moments exactly, the result does
+ * not depend on the order of the entries. Merging
+ * per-thread histograms then gives bit-for-bit the
+ * moments of a single-threaded run.
+ *
+ * @note to be called before filling
+ * @note the bin contents of weighted histograms
+ * still depend on the order of the entries
+ */
+void fH1D::set_deterministic(bool flag) {
+	if (flag == deterministic) {return ;}
+	if (flag) {
+		exact_sumw.add(sumw);
+		exact_sum.add(sum);
+		exact_sum2.add(sum2);
+	}
+	else {
+		sumw = exact_sumw.value();
+		sum = exact_sum.value();
+		sum2 = exact_sum2.value();
+		exact_sumw.reset();
+		exact_sum.reset();
+		exact_sum2.reset();
+	}
+	deterministic = flag;
+}
+
+/**
+ * Set the statistics (e.g when the bin contents come
+ * from another storage with set_bin_content)
+ */
+void fH1D::set_stats(unsigned long int _nEntries, unsigned long int _underflow, unsigned long int _overflow, double _sumw, double _sum, double _sum2) {
+	nEntries = _nEntries;
+	underflow = _underflow;
+	overflow = _overflow;
+	sumw = _sumw;
+	sum = _sum;
+	sum2 = _sum2;
+	if (deterministic) {
+		exact_sumw.reset(); exact_sumw.add(sumw);
+		exact_sum.reset(); exact_sum.add(sum);
+		exact_sum2.reset(); exact_sum2.add(sum2);
+	}
+}
+
+/**
+ * Automatic range : the first buffer_size entries are
+ * only stored. The range is then chosen from them (nice
+ * bin width, same number of bins), they are filled and
+ * the next entries are filled directly. Entries outside
+ * the chosen range later go to the underflow/overflow.
+ *
+ * The range is fixed when the buffer is full, or by
+ * fix_range() (called by merge, print and draw_with_cairo).
+ * Until then the getters see an empty histogram.
+ *
+ * @note to be called before filling, the binning becomes uniform
+ */
+void fH1D::enable_auto_range(int buffer_size) {
+	if (buffer_size < 1) {return ;}
+	reset();
+	autorange_size = buffer_size;
+	autorange_x.reserve(buffer_size);
+	autorange_w.reserve(buffer_size);
+}
+
+bool fH1D::is_range_fixed() const { return autorange_size == 0;}
+
+int fH1D::buffer_entries(const double* x, const double* w, int n) {
+	int m = std::min(n, autorange_size - (int) autorange_x.size());
+	autorange_x.insert(autorange_x.end(), x, x + m);
+	if (w == nullptr) { autorange_w.insert(autorange_w.end(), m, 1.0);}
+	else { autorange_w.insert(autorange_w.end(), w, w + m);}
+	if ((int) autorange_x.size() >= autorange_size) { fix_range();}
+	return m;
+}
+
+/**
+ * The bin width is the smallest of 1, 2, 2.5, 5 x 10^k such
+ * that nbins bins starting at a multiple of it cover all the
+ * buffered (finite) values.
+ */
+void fH1D::fix_range() {
+	if (autorange_size == 0) {return ;}
+	autorange_size = 0;
+	double vmin = 0, vmax = 0;
+	bool first = true;
+	for (double x : autorange_x) {
+		if (!std::isfinite(x)) { continue;}
+		vmin = first ? x : std::min(vmin, x);
+		vmax = first ? x : std::max(vmax, x);
+		first = false;
+	}
+	double raw = (vmax - vmin)/nbins;
+	if (raw <= 0) { raw = std::max(std::fabs(vmin), 1.0)/nbins;}
+	double step = std::pow(10.0, std::floor(std::log10(raw)));
+	const double nice[] = {1.0, 2.0, 2.5, 5.0, 10.0, 20.0};
+	double w = step;
+	for (double f : nice) {
+		w = f*step;
+		if ((f*step >= raw) && (vmax < (std::floor(vmin/w) + nbins)*w)) { break;}
+	}
+	while (vmax >= (std::floor(vmin/w) + nbins)*w) { w *= 2;}
+	xmin = std::floor(vmin/w)*w;
+	xmax = xmin + nbins*w;
+	binning = BINNING_UNIFORM;
+	edges.clear();
+	lut.clear();
+	init();
+	mark_dirty(0, nbins);
+	std::vector<double> x, wx;
+	x.swap(autorange_x);
+	wx.swap(autorange_w);
+	fill_batch(x.data(), wx.data(), x.size());
+}
+
+/**
+ * Attach a quantile sketch (t-digest) fed by fill and
+ * fill_batch, its memory is bounded by the compression
+ * (about 'compression' centroids). The quantiles are
+ * then free of binning artifacts.
+ *
+ * @note to be called before filling
+ */
+void fH1D::enable_quantiles(double compression) {
+	quantiles_enabled = true;
+	quantiles = fTDigest(compression);
+}
+
+bool fH1D::has_quantiles() const { return quantiles_enabled;}
+
+fTDigest& fH1D::getQuantileSketch() { return quantiles;}
+const fTDigest& fH1D::getQuantileSketch() const { return quantiles;}
+
+/**
+ * @param q in [0, 1]
+ * @note without sketch the quantile is interpolated
+ * linearly inside the bin where it falls
+ */
+double fH1D::getQuantile(double q) const {
+	if (quantiles_enabled) { return quantiles.quantile(q);}
+	double total = 0;
+	for (int i = 0; i < nbins; i++) { total += binBuffer[i];}
+	if (total <= 0) { return NAN;}
+	double target = q*total;
+	double cum = 0;
+	for (int i = 0; i < nbins; i++) {
+		if ((binBuffer[i] > 0) && (cum + binBuffer[i] >= target)) {
+			return getBinLowEdge(i) + getBinWidth(i)*(target - cum)/binBuffer[i];
+		}
+		cum += binBuffer[i];
+	}
+	return xmax;
+}
+
+double fH1D::getMedian() const { return getQuantile(0.5);}
+
+/**
+ * Add the contents and the statistics of another
+ * histogram with the same binning
+ *
+ * @return false if the binnings are different
+ */
+bool fH1D::merge(const fH1D& other) {
+	if (other.autorange_size > 0) { // nothing binned yet in other
+		fill_batch(other.autorange_x.data(), other.autorange_w.data(), other.autorange_x.size());
+		return true;
+	}
+	if (autorange_size > 0) { fix_range();}
+	if ((nbins != other.nbins) || (xmin != other.xmin) || (xmax != other.xmax) || (edges != other.edges)) {
+		printf("Cannot merge %s with %s : different binnings\n", title.c_str(), other.title.c_str());
+		return false;
+	}
+	for (int i = 0; i < nbins; i++) {
+		binBuffer[i] += other.binBuffer[i];
+	}
+	mark_dirty(0, nbins);
+	underflow += other.underflow;
+	overflow += other.overflow;
+	nEntries += other.nEntries;
+	if (quantiles_enabled) { quantiles.merge(other.quantiles);}
+	if (deterministic) {
+		if (other.deterministic) {
+			exact_sumw.add(other.exact_sumw);
+			exact_sum.add(other.exact_sum);
+			exact_sum2.add(other.exact_sum2);
+		}
+		else {
+			exact_sumw.add(other.sumw);
+			exact_sum.add(other.sum);
+			exact_sum2.add(other.sum2);
+		}
+	}
+	else {
+		sumw += other.getSumOfWeights();
+		sum += other.deterministic ? other.exact_sum.value() : other.sum;
+		sum2 += other.deterministic ? other.exact_sum2.value() : other.sum2;
+	}
+	return true;
+}
+
+fH1DShards::fH1DShards(const fH1D& model, int nthreads) {
+	fH1D empty = model;
+	empty.reset();
+	shards.assign(std::max(nthreads, 1), Shard{empty});
+}
+
+fH1D& fH1DShards::get(int thread) { return shards[thread].h;}
+
+int fH1DShards::size() const { return shards.size();}
+
+/**
+ * Merge the shards in the thread order, the result
+ * is deterministic for a given distribution of the
+ * entries (and independent of it if the model is
+ * deterministic, see fH1D::set_deterministic).
+ */
+fH1D fH1DShards::merge() const {
+	fH1D result = shards[0].h;
+	for (int i = 1; i < (int) shards.size(); i++) {
+		result.merge(shards[i].h);
+	}
+	return result;
 }
 
 void fH1D::print() {
+	if (autorange_size > 0) { fix_range();}
 	printf("Title : %s , nEntries : %ld , mean : %lf , stdev : %lf \n", title.c_str(), getEntries(), getMean(), getStDev());
 	fAxis ay(0, 100);
 	printf("\033[32m");
@@ -135,10 +778,16 @@ void fH1D::print() {
 	}
 	printf("  ====> this axis need to be fixed !!!!");
 	printf("\n");
+	double vmax = getMax();
 	for (int bin = 0; bin < nbins; bin++) {
 		printf("\033[32m");
-		int height = 100*getBinBufferContent(bin)/getMax();
-		printf("%10.2lf ", getBinArrayContent(bin));
+		int height = 100*getBinBufferContent(bin)/vmax;
+		if (binning == BINNING_UNIFORM) {
+			printf("%10.2lf ", getBinArrayContent(bin));
+		}
+		else { // the bin widths are not all the same, print the edges
+			printf("[%10.4lg, %10.4lg[ ", getBinLowEdge(bin), getBinUpEdge(bin));
+		}
 		//printf("%*.d ", (int) ceil(log10(nbins)), bin);
 		for (int h = 0; h < height; h++) {
 			printf(u8"█");
@@ -152,8 +801,23 @@ void fH1D::print() {
 //ou télécharger cairo
 //draw(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height){
 void fH1D::draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height) {
+	if (autorange_size > 0) { fix_range();}
+	// Visible range (see set_view)
+	double x0 = view_set ? view_xmin : xmin;
+	double x1 = view_set ? view_xmax : xmax;
+	auto bin_of = [this] (double x) { // bin containing x, clamped to [0, nbins]
+		int bin = getBinNumber(x);
+		return (bin == -1) ? 0 : ((bin == -11) ? nbins : bin);
+	};
+	int first = bin_of(x0);
+	int last = bin_of(x1); // bins [first, last[ are visible
+	last = ((last < nbins) && (x1 > getBinLowEdge(last))) ? last + 1 : last;
+	last = std::max(last, first + 1);
+	// More bins than pixels : the pyramid gives the maximum of each column
+	if ((last - first > width) && !pyramid_enabled) { enable_pyramid();}
+	fPyramidNode visible = getRangeStats(first, last);
 	// Define the main canvas
-	fCanvas canvas(width, height, xmin, xmax, 0, getMax());
+	fCanvas canvas(width, height, x0, x1, 0, std::max(visible.max, 0.0));
 	canvas.define_coord_system(cr);
 	//canvas.draw_frame(cr);
 	canvas.draw_title(cr, title);
@@ -162,15 +826,29 @@ void fH1D::draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, i
 	// Draw contour	
 	cr->set_source_rgb(0.0, 0.0, 1.0);
 	cr->set_line_width(0.008*canvas.get_seff());
-	cr->move_to(canvas.x2w(xmin), canvas.y2h(0.0));
-	for (int bin = 0; bin < nbins; bin++) {
-		double x = binArray[bin] - 0.5*binw;
-		double y = binBuffer[bin];
-		//cr->move_to();
-		cr->line_to(canvas.x2w(x), canvas.y2h(y));
-		cr->line_to(canvas.x2w(x + binw), canvas.y2h(y));
+	cr->move_to(canvas.x2w(x0), canvas.y2h(0.0));
+	int w0 = canvas.x2w(x0);
+	int w1 = canvas.x2w(x1);
+	if (last - first <= w1 - w0) { // one step per bin
+		for (int bin = first; bin < last; bin++) {
+			double y = binBuffer[bin];
+			//cr->move_to();
+			cr->line_to(canvas.x2w(std::max(getBinLowEdge(bin), x0)), canvas.y2h(y));
+			cr->line_to(canvas.x2w(std::min(getBinUpEdge(bin), x1)), canvas.y2h(y));
+		}
+	}
+	else { // one column per pixel, at the maximum of its bins
+		int b0 = first;
+		for (int w = w0; w < w1; w++) {
+			int b1 = std::max(bin_of(canvas.w2x(w + 1)), b0 + 1);
+			b1 = std::min(b1, last);
+			double y = getRangeStats(b0, b1).max;
+			cr->line_to(w, canvas.y2h(y));
+			cr->line_to(w + 1, canvas.y2h(y));
+			b0 = std::min(b1, last - 1);
+		}
 	}
-	cr->line_to(canvas.x2w(xmax), canvas.y2h(0.0));
+	cr->line_to(canvas.x2w(x1), canvas.y2h(0.0));
 	cr->stroke_preserve(); // preserve the path
 	cr->close_path();
 	cr->set_source_rgb(fill_color.r, fill_color.g, fill_color.b);
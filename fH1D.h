@@ -0,0 +1,173 @@
+/***********************************************
+ * Class for 1D histogram
+ *
+ * designed to be used in gtkmm
+ * drawing area
+ *
+ * @author Felix Touchte Codjo
+ * @date February 12, 2025
+ * ********************************************/
+
+#ifndef F_H1D_H
+#define F_H1D_H
+
+#include "fExactSum.h"
+#include "fTDigest.h"
+#include <gtkmm.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/** How the bins of a fH1D are defined */
+enum fBinning {
+	BINNING_UNIFORM, ///< nbins of the same width between xmin and xmax
+	BINNING_VARIABLE, ///< given bin edges
+	BINNING_LOG ///< nbins of the same width in log(x) between xmin and xmax
+};
+
+/** min, max and sum of the contents of a range of bins */
+struct fPyramidNode {
+	double min;
+	double max;
+	double sum;
+};
+
+struct fColor {
+	double r;
+	double g;
+	double b;
+};
+
+class fH1D {
+private :
+	std::string title;
+	std::string xtitle;
+	std::string ytitle;
+	int nbins; ///< number of bins
+	double xmin; ///< lower edge of the first bin
+	double xmax; ///< upper edge of the last bin
+	double binw; ///< bin width (mean bin width if the binning is not uniform)
+	double inv_binw; ///< 1/binw, used by the arithmetic bin lookup
+	fBinning binning; ///< type of binning
+	std::vector<double> edges; ///< nbins+1 bin edges (empty if the binning is uniform)
+	double inv_logw; ///< nbins/log2(xmax/xmin), used by the logarithmic bin lookup
+	std::vector<double> binBuffer; ///< bin contents
+	unsigned long int underflow; ///< number of entries below xmin
+	unsigned long int overflow; ///< number of entries above xmax
+	unsigned long int nEntries; ///< number of entries in [xmin, xmax[
+	double sumw; ///< sum of weights
+	double sum; ///< sum of w*x
+	double sum2; ///< sum of w*x*x
+	fColor fill_color = {0.0, 0.0, 1.0};
+
+	bool deterministic = false; ///< accumulate the moments exactly (see set_deterministic)
+	fExactSum exact_sumw; ///< exact version of sumw
+	fExactSum exact_sum; ///< exact version of sum
+	fExactSum exact_sum2; ///< exact version of sum2
+
+	bool quantiles_enabled = false; ///< feed the quantile sketch (see enable_quantiles)
+	fTDigest quantiles; ///< quantile sketch of the entries in [xmin, xmax[
+
+	// multi-resolution pyramid (see enable_pyramid), updated lazily by the const getters
+	bool pyramid_enabled = false;
+	mutable std::vector<std::vector<fPyramidNode>> pyramid; ///< pyramid[k] : nodes covering 2^(k+1) bins
+	mutable int dirty_lo = 0; ///< first bin changed since the last pyramid update
+	mutable int dirty_hi = 0; ///< last bin changed since the last pyramid update + 1
+	void mark_dirty(int lo, int hi); ///< bins [lo, hi[ changed
+	void update_pyramid_bin(int bin); ///< recompute the nodes above a bin
+	void update_pyramid() const; ///< recompute the nodes above the dirty bins
+	fPyramidNode getNode(int level, int j) const; ///< level 0 is the bin contents
+	bool view_set = false; ///< draw only [view_xmin, view_xmax]
+	double view_xmin;
+	double view_xmax;
+
+	// automatic range (see enable_auto_range)
+	int autorange_size = 0; ///< number of entries to buffer before fixing the range, 0 if the range is fixed
+	std::vector<double> autorange_x; ///< buffered values
+	std::vector<double> autorange_w; ///< buffered weights
+	int buffer_entries(const double* x, const double* w, int n); ///< buffer up to n entries, return how many were taken
+
+	int lut_min; ///< first integer covered by the lookup table
+	std::vector<int> lut; ///< bin number of each integer in [lut_min, lut_min + lut.size()[
+	void build_lut(); ///< fill the lookup table used by the integer fast path
+	void accumulate(const double* x, const double* w, const int* bins, int m); ///< add a chunk of values already binned
+	void init(); ///< allocate and clear the contents
+	int searchEdges(double x) const; ///< binary search in edges, x must be in [xmin, xmax[
+public :
+	fH1D(std::string _title, int _nbins, double _xmin, double _xmax, bool logbins = false);
+	fH1D(std::string _title, std::vector<double> _edges);
+	void fill(double x);
+	void fill(double x, double w);
+	void fill_batch(const double* x, int n);
+	void fill_batch(const double* x, const double* w, int n);
+	void fill_batch(const std::vector<double>& x);
+	void fill_batch(const int16_t* x, int n, const double* w = nullptr); ///< integer ADC fast path
+	int getBinNumber(double x) const;
+	double getBinBufferContent(int bin) const;
+	double getBinArrayContent(int bin) const;
+	unsigned long int getEntries() const;
+	double getMean() const;
+	double getStDev() const;
+	double getBinWidth() const;
+	double getBinWidth(int bin) const;
+	double getBinLowEdge(int bin) const;
+	double getBinUpEdge(int bin) const;
+	fBinning getBinning() const;
+	int getNumberOfBins() const;
+	std::vector<double> getBinArray() const;
+	std::vector<double> getBinBuffer() const;
+	double getMax() const;
+	fPyramidNode getRangeStats(int first, int last) const; ///< min, max and sum of the bins [first, last[
+	void enable_pyramid();
+	void set_view(double x0, double x1); ///< zoom, draw_with_cairo only draws [x0, x1]
+	void reset_view();
+	double getSumOfWeights() const;
+	double getSum() const; ///< sum of w*x
+	double getSum2() const; ///< sum of w*x*x
+	double getXmin() const;
+	double getXmax() const;
+	std::string getTitle() const;
+	std::string getXtitle() const;
+	std::string getYtitle() const;
+	const std::vector<double>& getEdges() const; ///< empty if the binning is uniform
+	unsigned long int getUnderflow() const;
+	unsigned long int getOverflow() const;
+	bool merge(const fH1D& other);
+	void set_deterministic(bool flag);
+	void enable_auto_range(int buffer_size = 10000);
+	void fix_range(); ///< choose the range from the buffered entries and fill them
+	bool is_range_fixed() const;
+	void enable_quantiles(double compression = 200);
+	bool has_quantiles() const;
+	double getQuantile(double q) const; ///< from the sketch if enabled, from the bin contents otherwise
+	double getMedian() const;
+	fTDigest& getQuantileSketch();
+	const fTDigest& getQuantileSketch() const;
+	void set_xtitle(std::string name);
+	void set_ytitle(std::string name);
+	void set_bin_content(int bin, double content);
+	void set_stats(unsigned long int _nEntries, unsigned long int _underflow, unsigned long int _overflow, double _sumw, double _sum, double _sum2);
+	void reset();
+	void print();
+	void draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height);
+	void set_fill_color(fColor color);
+};
+
+/**
+ * One copy of a histogram per thread
+ *
+ * Each thread fills its own shard without any lock,
+ * the shards are merged in the thread order at the end.
+ */
+class fH1DShards {
+private :
+	struct alignas(64) Shard { fH1D h; }; ///< one cache line at least between two shards
+	std::vector<Shard> shards;
+public :
+	fH1DShards(const fH1D& model, int nthreads);
+	fH1D& get(int thread);
+	int size() const;
+	fH1D merge() const;
+};
+
+#endif
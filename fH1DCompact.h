@@ -0,0 +1,149 @@
+/***********************************************
+ * Compact 1D histogram
+ *
+ * For large banks of histograms (e.g one per
+ * wire and per quantity). Uniform binning only,
+ * the bin centers are computed on demand.
+ *
+ * Count : type of the bin contents (uint16_t,
+ *         uint32_t, float or double). Integer
+ *         contents saturate instead of wrapping.
+ * N     : number of bins known at compile time,
+ *         the contents are then stored inline
+ *         (no heap allocation). N = 0 means the
+ *         number of bins is given at run time.
+ *
+ * e.g. std::vector<fH1DCompact<uint32_t, 100>> bank(576, {0, 500});
+ *      (the RMS of each wire in rms.exe)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_H1D_COMPACT_H
+#define F_H1D_COMPACT_H
+
+#include "fH1D.h"
+#include <array>
+#include <vector>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <type_traits>
+
+template <typename Count, int N = 0>
+class fH1DCompact {
+private :
+	using Storage = typename std::conditional<N == 0, std::vector<Count>, std::array<Count, (N > 0 ? N : 1)>>::type;
+	Storage binBuffer; ///< bin contents
+	int nbins;
+	double xmin;
+	double xmax;
+	double inv_binw; ///< nbins/(xmax - xmin)
+	uint32_t underflow = 0;
+	uint32_t overflow = 0;
+	uint32_t nEntries = 0;
+	double sumw = 0; ///< sum of weights
+	double sum = 0; ///< sum of w*x
+	double sum2 = 0; ///< sum of w*x*x
+
+	static void add(Count& c, double w) {
+		if constexpr (std::is_integral<Count>::value) {
+			double v = c + w;
+			double top = std::numeric_limits<Count>::max();
+			c = (v < 0) ? 0 : ((v > top) ? std::numeric_limits<Count>::max() : (Count) v);
+		}
+		else {
+			c += w;
+		}
+	}
+public :
+	/** fixed number of bins : N (only when N > 0) */
+	template <int M = N, typename std::enable_if<(M > 0), int>::type = 0>
+	fH1DCompact(double _xmin, double _xmax) : nbins(N), xmin(_xmin), xmax(_xmax) {
+		inv_binw = nbins/(xmax - xmin);
+		binBuffer.fill(0);
+	}
+
+	/** number of bins given at run time (only when N = 0) */
+	template <int M = N, typename std::enable_if<(M == 0), int>::type = 0>
+	fH1DCompact(int _nbins, double _xmin, double _xmax) : nbins(_nbins), xmin(_xmin), xmax(_xmax) {
+		inv_binw = nbins/(xmax - xmin);
+		binBuffer.assign(nbins, 0);
+	}
+
+	/**
+	 * @note numerotation starts at 0
+	 * @note return -1 if underflow (or nan) and -11 if overflow
+	 */
+	int getBinNumber(double x) const {
+		if (!(x >= xmin)) {return -1;}
+		if (x >= xmax) {return -11;}
+		int bin = (x - xmin)*inv_binw;
+		return (bin < nbins) ? bin : nbins - 1;
+	}
+
+	void fill(double x) { fill(x, 1.0);}
+
+	void fill(double x, double w) {
+		int bin = getBinNumber(x);
+		if (bin == -1) { underflow++; return ;}
+		if (bin == -11) { overflow++; return ;}
+		nEntries++;
+		add(binBuffer[bin], w);
+		sumw += w;
+		sum += w*x;
+		sum2 += w*x*x;
+	}
+
+	void fill_batch(const double* x, int n) {
+		for (int i = 0; i < n; i++) { fill(x[i]);}
+	}
+
+	double getBinBufferContent(int bin) const {
+		if ((bin < 0) || (bin >= nbins)) { return 0;}
+		return binBuffer[bin];
+	}
+	double getBinArrayContent(int bin) const { return xmin + (bin + 0.5)/inv_binw;} ///< center of the bin
+	int getNumberOfBins() const { return nbins;}
+	unsigned long int getEntries() const { return nEntries;}
+	double getMean() const { return sum/sumw;}
+	double getStDev() const { return sqrt(sum2/sumw - getMean()*getMean());}
+
+	bool merge(const fH1DCompact& other) {
+		if ((nbins != other.nbins) || (xmin != other.xmin) || (xmax != other.xmax)) {
+			printf("Cannot merge histograms with different binnings\n");
+			return false;
+		}
+		for (int i = 0; i < nbins; i++) { add(binBuffer[i], other.binBuffer[i]);}
+		underflow += other.underflow;
+		overflow += other.overflow;
+		nEntries += other.nEntries;
+		sumw += other.sumw;
+		sum += other.sum;
+		sum2 += other.sum2;
+		return true;
+	}
+
+	void reset() {
+		for (int i = 0; i < nbins; i++) { binBuffer[i] = 0;}
+		underflow = 0;
+		overflow = 0;
+		nEntries = 0;
+		sumw = 0;
+		sum = 0;
+		sum2 = 0;
+	}
+
+	/** full fH1D copy, e.g for drawing */
+	fH1D to_fH1D(std::string title) const {
+		fH1D h(title, nbins, xmin, xmax);
+		for (int i = 0; i < nbins; i++) { h.set_bin_content(i, binBuffer[i]);}
+		h.set_stats(nEntries, underflow, overflow, sumw, sum, sum2);
+		return h;
+	}
+
+};
+
+#endif
@@ -0,0 +1,384 @@
+/***********************************************
+ * Class for 2D histogram
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fH2D.h"
+#include "fCanvas.h"
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+fH2D::fH2D(std::string _title, int _nbinsx, double _xmin, double _xmax, int _nbinsy, double _ymin, double _ymax) : title(_title), nbinsx(_nbinsx), xmin(_xmin), xmax(_xmax), nbinsy(_nbinsy), ymin(_ymin), ymax(_ymax) {
+	if (!(xmin <= xmax) || !(ymin <= ymax) || (nbinsx < 1) || (nbinsy < 1)) { // also nan
+		printf("Histogram parameters are incorrects : xmax < xmin, ymax < ymin or no bin\n");
+		nbinsx = 0; // no bin : set_bin_content and fill never index the buffer
+		nbinsy = 0;
+	}
+	binwx = (xmax - xmin)/nbinsx;
+	binwy = (ymax - ymin)/nbinsy;
+	inv_binwx = nbinsx/(xmax - xmin);
+	inv_binwy = nbinsy/(ymax - ymin);
+	binBuffer.assign(nbinsx*nbinsy, 0.0);
+	outside = 0;
+	nEntries = 0;
+	sumw = 0;
+	sumx = 0;
+	sumx2 = 0;
+	sumy = 0;
+	sumy2 = 0;
+	sumxy = 0;
+}
+
+/**
+ * @note numerotation starts at 0
+ * @note return -1 if underflow (or nan) and -11 if overflow
+ */
+int fH2D::getBinNumberX(double x) const {
+	if (!(x >= xmin)) {return -1;}
+	if (x >= xmax) {return -11;}
+	int bin = (x - xmin)*inv_binwx;
+	return (bin < nbinsx) ? bin : nbinsx - 1;
+}
+
+int fH2D::getBinNumberY(double y) const {
+	if (!(y >= ymin)) {return -1;}
+	if (y >= ymax) {return -11;}
+	int bin = (y - ymin)*inv_binwy;
+	return (bin < nbinsy) ? bin : nbinsy - 1;
+}
+
+/**
+ * @return index of the bin in the buffer, -1 if (x,y) is outside
+ */
+int fH2D::getBinNumber(double x, double y) const {
+	int ix = getBinNumberX(x);
+	int iy = getBinNumberY(y);
+	if ((ix < 0) || (iy < 0)) {return -1;}
+	return iy*nbinsx + ix;
+}
+
+void fH2D::fill(double x, double y) {
+	fill(x, y, 1.0);
+}
+
+void fH2D::fill(double x, double y, double w) {
+	int bin = getBinNumber(x, y);
+	if (bin < 0) { outside++; return ;}
+	nEntries++;
+	binBuffer[bin] += w;
+	sumw += w;
+	sumx += w*x;
+	sumx2 += w*x*x;
+	sumy += w*y;
+	sumy2 += w*y*y;
+	sumxy += w*x*y;
+}
+
+void fH2D::fill_batch(const double* x, const double* y, int n) {
+	fill_batch(x, y, nullptr, n);
+}
+
+/**
+ * fill n points (x[i], y[i]) with weights w[i]
+ *
+ * The buffer indices of a chunk of points are computed
+ * in a loop without branches, then the contents and
+ * the moments are accumulated.
+ *
+ * @note w == nullptr means a weight of 1 for all points
+ */
+void fH2D::fill_batch(const double* x, const double* y, const double* w, int n) {
+	const int chunk = 256;
+	int bins[chunk];
+	const double topx = nbinsx - 1;
+	const double topy = nbinsy - 1;
+	for (int start = 0; start < n; start += chunk) {
+		int m = std::min(chunk, n - start);
+		const double* xc = x + start;
+		const double* yc = y + start;
+		const double* wc = (w == nullptr) ? nullptr : w + start;
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			double tx = (xc[i] - xmin)*inv_binwx;
+			double ty = (yc[i] - ymin)*inv_binwy;
+			tx = (tx > 0) ? tx : 0; // also catches nan
+			ty = (ty > 0) ? ty : 0;
+			tx = (tx < topx) ? tx : topx;
+			ty = (ty < topy) ? ty : topy;
+			int bin = ((int) ty)*nbinsx + (int) tx;
+			bool inside = (xc[i] >= xmin) && (xc[i] < xmax) && (yc[i] >= ymin) && (yc[i] < ymax);
+			bins[i] = inside ? bin : -1;
+		}
+		accumulate(xc, yc, wc, bins, m);
+	}
+}
+
+void fH2D::accumulate(const double* x, const double* y, const double* w, const int* bins, int m) {
+	double* content = binBuffer.data();
+	double s0 = 0, sx = 0, sx2 = 0, sy = 0, sy2 = 0, sxy = 0;
+	for (int i = 0; i < m; i++) {
+		if (bins[i] < 0) { outside++; continue;}
+		double wi = (w == nullptr) ? 1.0 : w[i];
+		content[bins[i]] += wi;
+		s0 += wi;
+		sx += wi*x[i];
+		sx2 += wi*x[i]*x[i];
+		sy += wi*y[i];
+		sy2 += wi*y[i]*y[i];
+		sxy += wi*x[i]*y[i];
+		nEntries++;
+	}
+	sumw += s0;
+	sumx += sx;
+	sumx2 += sx2;
+	sumy += sy;
+	sumy2 += sy2;
+	sumxy += sxy;
+}
+
+double fH2D::getBinContent(int ix, int iy) const {
+	if ((ix < 0) || (ix >= nbinsx) || (iy < 0) || (iy >= nbinsy)) {
+		return 0;
+	}
+	return binBuffer[iy*nbinsx + ix];
+}
+
+double fH2D::getBinCenterX(int ix) const { return xmin + (ix + 0.5)*binwx;}
+double fH2D::getBinCenterY(int iy) const { return ymin + (iy + 0.5)*binwy;}
+unsigned long int fH2D::getEntries() const { return nEntries;}
+unsigned long int fH2D::getOutside() const { return outside;}
+double fH2D::getSumOfWeights() const { return sumw;}
+void fH2D::getSums(double sums[6]) const {
+	sums[0] = sumw;
+	sums[1] = sumx;
+	sums[2] = sumx2;
+	sums[3] = sumy;
+	sums[4] = sumy2;
+	sums[5] = sumxy;
+}
+double fH2D::getXmin() const { return xmin;}
+double fH2D::getXmax() const { return xmax;}
+double fH2D::getYmin() const { return ymin;}
+double fH2D::getYmax() const { return ymax;}
+std::string fH2D::getTitle() const { return title;}
+std::string fH2D::getXtitle() const { return xtitle;}
+std::string fH2D::getYtitle() const { return ytitle;}
+double fH2D::getMeanX() const { return sumx/sumw;}
+double fH2D::getMeanY() const { return sumy/sumw;}
+double fH2D::getStDevX() const { return sqrt(sumx2/sumw - getMeanX()*getMeanX());}
+double fH2D::getStDevY() const { return sqrt(sumy2/sumw - getMeanY()*getMeanY());}
+double fH2D::getCorrelation() const {
+	double cov = sumxy/sumw - getMeanX()*getMeanY();
+	return cov/(getStDevX()*getStDevY());
+}
+int fH2D::getNumberOfBinsX() const { return nbinsx;}
+int fH2D::getNumberOfBinsY() const { return nbinsy;}
+const std::vector<double>& fH2D::getBinBuffer() const { return binBuffer;}
+void fH2D::set_xtitle(std::string name) { xtitle = name;}
+void fH2D::set_ytitle(std::string name) { ytitle = name;}
+
+void fH2D::set_bin_content(int ix, int iy, double content) {
+	if ((ix < 0) || (ix >= nbinsx) || (iy < 0) || (iy >= nbinsy)) {return ;}
+	binBuffer[iy*nbinsx + ix] = content;
+}
+
+/**
+ * Set the statistics (e.g when the bin contents come
+ * from another storage with set_bin_content)
+ *
+ * @param sums sumw, sumx, sumx2, sumy, sumy2, sumxy
+ */
+void fH2D::set_stats(unsigned long int _nEntries, unsigned long int _outside, const double sums[6]) {
+	nEntries = _nEntries;
+	outside = _outside;
+	sumw = sums[0];
+	sumx = sums[1];
+	sumx2 = sums[2];
+	sumy = sums[3];
+	sumy2 = sums[4];
+	sumxy = sums[5];
+}
+
+double fH2D::getMax() const {
+	double vmax = 0;
+	for (double v : binBuffer) {
+		vmax = (vmax < v) ? v : vmax;
+	}
+	return vmax;
+}
+
+fH2DSlice fH2D::getSliceX(int iy) const {
+	return fH2DSlice{binBuffer.data() + iy*nbinsx, nbinsx, 1};
+}
+
+fH2DSlice fH2D::getSliceY(int ix) const {
+	return fH2DSlice{binBuffer.data() + ix, nbinsy, nbinsx};
+}
+
+/**
+ * Sum of the rows iy_first to iy_last (included),
+ * only these rows are read.
+ *
+ * @note iy_last = -1 means the last row
+ * @note the sum of weights is exact. With all the rows, the
+ * entries and the moments are those of the 2D histogram (exact).
+ * With some rows, the moments are computed from the bin centers
+ * and the entries are nEntries*(weight of the rows)/sumw (exact
+ * for weights of 1), both approximate.
+ * @note the underflow and overflow are 0 : the entries outside
+ * of the 2D histogram are not stored per row or per side
+ */
+fH1D fH2D::projectionX(int iy_first, int iy_last) const {
+	if (iy_last < 0) { iy_last = nbinsy - 1;}
+	iy_first = std::max(iy_first, 0);
+	iy_last = std::min(iy_last, nbinsy - 1);
+	fH1D h(title + "_px", nbinsx, xmin, xmax);
+	h.set_xtitle(xtitle);
+	std::vector<double> content(nbinsx, 0.0);
+	for (int iy = iy_first; iy <= iy_last; iy++) {
+		const double* row = binBuffer.data() + iy*nbinsx;
+		for (int ix = 0; ix < nbinsx; ix++) {
+			content[ix] += row[ix];
+		}
+	}
+	double w = 0, wx = 0, wx2 = 0;
+	for (int ix = 0; ix < nbinsx; ix++) {
+		h.set_bin_content(ix, content[ix]);
+		double x = getBinCenterX(ix);
+		w += content[ix];
+		wx += content[ix]*x;
+		wx2 += content[ix]*x*x;
+	}
+	if ((iy_first == 0) && (iy_last == nbinsy - 1)) {
+		h.set_stats(nEntries, 0, 0, sumw, sumx, sumx2);
+	}
+	else {
+		unsigned long int entries = (sumw != 0) ? llround(nEntries*w/sumw) : 0;
+		h.set_stats(entries, 0, 0, w, wx, wx2);
+	}
+	return h;
+}
+
+/**
+ * Sum of the columns ix_first to ix_last (included),
+ * only these columns are read.
+ *
+ * @note ix_last = -1 means the last column
+ * @note the statistics as in projectionX : exact with all the
+ * columns, from the bin centers with some columns
+ */
+fH1D fH2D::projectionY(int ix_first, int ix_last) const {
+	if (ix_last < 0) { ix_last = nbinsx - 1;}
+	ix_first = std::max(ix_first, 0);
+	ix_last = std::min(ix_last, nbinsx - 1);
+	fH1D h(title + "_py", nbinsy, ymin, ymax);
+	h.set_xtitle(ytitle);
+	double w = 0, wy = 0, wy2 = 0;
+	for (int iy = 0; iy < nbinsy; iy++) {
+		const double* row = binBuffer.data() + iy*nbinsx;
+		double content = 0;
+		for (int ix = ix_first; ix <= ix_last; ix++) {
+			content += row[ix];
+		}
+		h.set_bin_content(iy, content);
+		double y = getBinCenterY(iy);
+		w += content;
+		wy += content*y;
+		wy2 += content*y*y;
+	}
+	if ((ix_first == 0) && (ix_last == nbinsx - 1)) {
+		h.set_stats(nEntries, 0, 0, sumw, sumy, sumy2);
+	}
+	else {
+		unsigned long int entries = (sumw != 0) ? llround(nEntries*w/sumw) : 0;
+		h.set_stats(entries, 0, 0, w, wy, wy2);
+	}
+	return h;
+}
+
+/**
+ * Add the contents and the statistics of another
+ * histogram with the same binning
+ *
+ * @return false if the binnings are different
+ */
+bool fH2D::merge(const fH2D& other) {
+	if ((nbinsx != other.nbinsx) || (xmin != other.xmin) || (xmax != other.xmax) ||
+	    (nbinsy != other.nbinsy) || (ymin != other.ymin) || (ymax != other.ymax)) {
+		printf("Cannot merge %s with %s : different binnings\n", title.c_str(), other.title.c_str());
+		return false;
+	}
+	for (int i = 0; i < (int) binBuffer.size(); i++) {
+		binBuffer[i] += other.binBuffer[i];
+	}
+	outside += other.outside;
+	nEntries += other.nEntries;
+	sumw += other.sumw;
+	sumx += other.sumx;
+	sumx2 += other.sumx2;
+	sumy += other.sumy;
+	sumy2 += other.sumy2;
+	sumxy += other.sumxy;
+	return true;
+}
+
+void fH2D::reset() {
+	std::fill(binBuffer.begin(), binBuffer.end(), 0.0);
+	outside = 0;
+	nEntries = 0;
+	sumw = 0;
+	sumx = 0;
+	sumx2 = 0;
+	sumy = 0;
+	sumy2 = 0;
+	sumxy = 0;
+}
+
+void fH2D::print() {
+	printf("Title : %s , nEntries : %ld , meanX : %lf , stdevX : %lf , meanY : %lf , stdevY : %lf \n", title.c_str(), getEntries(), getMeanX(), getStDevX(), getMeanY(), getStDevY());
+	const char* levels = " .:-=+*#%@";
+	double vmax = getMax();
+	printf("\033[32m");
+	for (int iy = nbinsy - 1; iy >= 0; iy--) { // y axis upwards
+		printf("%10.2lf |", getBinCenterY(iy));
+		for (int ix = 0; ix < nbinsx; ix++) {
+			double v = (vmax > 0) ? 9*getBinContent(ix, iy)/vmax : 0;
+			int level = (v > 0) ? ((v < 9) ? (int) v : 9) : 0; // in [0, 9], also for negative or nan contents
+			printf("%c", levels[level]);
+		}
+		printf("\n");
+	}
+	printf("\033[37m");
+}
+
+/**
+ * Each non empty bin is drawn as a rectangle whose
+ * color goes from blue (low) to red (maximum)
+ */
+void fH2D::draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height) {
+	fCanvas canvas(width, height, xmin, xmax, ymin, ymax);
+	canvas.define_coord_system(cr);
+	canvas.draw_title(cr, title);
+	canvas.draw_xtitle(cr, xtitle);
+	canvas.draw_ytitle(cr, ytitle);
+	double vmax = getMax();
+	for (int iy = 0; iy < nbinsy; iy++) {
+		fH2DSlice row = getSliceX(iy);
+		double y1 = ymin + iy*binwy;
+		for (int ix = 0; ix < nbinsx; ix++) {
+			if (row[ix] <= 0) {continue;}
+			double level = row[ix]/vmax;
+			double x1 = xmin + ix*binwx;
+			cr->set_source_rgb(level, 0.2, 1.0 - level);
+			int w1 = canvas.x2w(x1), w2 = canvas.x2w(x1 + binwx);
+			int h1 = canvas.y2h(y1), h2 = canvas.y2h(y1 + binwy);
+			cr->rectangle(w1, h1, w2 - w1, h2 - h1);
+			cr->fill();
+		}
+	}
+	canvas.set_frame_line_width(0.005);
+	canvas.draw_frame(cr); // draw frame and axis at the end
+}
@@ -0,0 +1,102 @@
+/***********************************************
+ * Class for 2D histogram
+ *
+ * The bins are stored in a single row-major
+ * buffer : bin (ix, iy) is at iy*nbinsx + ix.
+ * Same API as fH1D.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_H2D_H
+#define F_H2D_H
+
+#include "fH1D.h"
+#include <gtkmm.h>
+#include <string>
+#include <vector>
+
+/**
+ * Read-only view on a line of bins of a fH2D,
+ * nothing is copied
+ */
+struct fH2DSlice {
+	const double* data; ///< first bin of the line
+	int n; ///< number of bins
+	int stride; ///< distance between two consecutive bins in the buffer
+	double operator[](int i) const { return data[i*stride];}
+};
+
+class fH2D {
+private :
+	std::string title;
+	std::string xtitle;
+	std::string ytitle;
+	int nbinsx; ///< number of bins along x
+	double xmin;
+	double xmax;
+	int nbinsy; ///< number of bins along y
+	double ymin;
+	double ymax;
+	double binwx; ///< bin width along x
+	double binwy; ///< bin width along y
+	double inv_binwx; ///< 1/binwx
+	double inv_binwy; ///< 1/binwy
+	std::vector<double> binBuffer; ///< bin contents, row-major (one row per y bin)
+	unsigned long int outside; ///< number of entries outside [xmin, xmax[ x [ymin, ymax[
+	unsigned long int nEntries; ///< number of entries inside
+	double sumw; ///< sum of weights
+	double sumx; ///< sum of w*x
+	double sumx2; ///< sum of w*x*x
+	double sumy; ///< sum of w*y
+	double sumy2; ///< sum of w*y*y
+	double sumxy; ///< sum of w*x*y
+	void accumulate(const double* x, const double* y, const double* w, const int* bins, int m); ///< add a chunk of values already binned
+public :
+	fH2D(std::string _title, int _nbinsx, double _xmin, double _xmax, int _nbinsy, double _ymin, double _ymax);
+	void fill(double x, double y);
+	void fill(double x, double y, double w);
+	void fill_batch(const double* x, const double* y, int n);
+	void fill_batch(const double* x, const double* y, const double* w, int n);
+	int getBinNumberX(double x) const;
+	int getBinNumberY(double y) const;
+	int getBinNumber(double x, double y) const;
+	double getBinContent(int ix, int iy) const;
+	double getBinCenterX(int ix) const;
+	double getBinCenterY(int iy) const;
+	unsigned long int getEntries() const;
+	unsigned long int getOutside() const;
+	double getSumOfWeights() const;
+	void getSums(double sums[6]) const; ///< sumw, sumx, sumx2, sumy, sumy2, sumxy
+	double getXmin() const;
+	double getXmax() const;
+	double getYmin() const;
+	double getYmax() const;
+	std::string getTitle() const;
+	std::string getXtitle() const;
+	std::string getYtitle() const;
+	double getMeanX() const;
+	double getMeanY() const;
+	double getStDevX() const;
+	double getStDevY() const;
+	double getCorrelation() const;
+	int getNumberOfBinsX() const;
+	int getNumberOfBinsY() const;
+	double getMax() const;
+	const std::vector<double>& getBinBuffer() const;
+	fH2DSlice getSliceX(int iy) const; ///< bins along x for the y bin iy (contiguous)
+	fH2DSlice getSliceY(int ix) const; ///< bins along y for the x bin ix (strided)
+	fH1D projectionX(int iy_first = 0, int iy_last = -1) const;
+	fH1D projectionY(int ix_first = 0, int ix_last = -1) const;
+	bool merge(const fH2D& other);
+	void set_xtitle(std::string name);
+	void set_ytitle(std::string name);
+	void set_bin_content(int ix, int iy, double content);
+	void set_stats(unsigned long int _nEntries, unsigned long int _outside, const double sums[6]);
+	void reset();
+	void print();
+	void draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height);
+};
+
+#endif
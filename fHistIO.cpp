@@ -0,0 +1,387 @@
+/***********************************************
+ * Binary file for many histograms (fH1D, fH2D,
+ * fProfile)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fHistIO.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace fHistIO;
+
+static void copy_name(char* dest, const std::string& src) {
+	memset(dest, 0, name_size);
+	strncpy(dest, src.c_str(), name_size - 1);
+}
+
+/** the names are truncated in the file, they must stay distinct */
+bool fHistWriter::has_name(const std::string& name) const {
+	std::string key = name.substr(0, name_size - 1);
+	for (const fH1D* h : h1) {
+		if (h->getTitle().substr(0, name_size - 1) == key) { return true;}
+	}
+	for (const fH2D* h : h2) {
+		if (h->getTitle().substr(0, name_size - 1) == key) { return true;}
+	}
+	for (const fProfile* p : profiles) {
+		if (p->getTitle().substr(0, name_size - 1) == key) { return true;}
+	}
+	return false;
+}
+
+bool fHistWriter::add(const fH1D* h) {
+	if (has_name(h->getTitle())) {
+		printf("fHistWriter : %s is already used, the histogram is not written\n", h->getTitle().c_str());
+		return false;
+	}
+	h1.push_back(h);
+	return true;
+}
+
+bool fHistWriter::add(const fH2D* h) {
+	if (has_name(h->getTitle())) {
+		printf("fHistWriter : %s is already used, the histogram is not written\n", h->getTitle().c_str());
+		return false;
+	}
+	h2.push_back(h);
+	return true;
+}
+
+bool fHistWriter::add(const fProfile* p) {
+	if (has_name(p->getTitle())) {
+		printf("fHistWriter : %s is already used, the profile is not written\n", p->getTitle().c_str());
+		return false;
+	}
+	profiles.push_back(p);
+	return true;
+}
+
+/**
+ * The data are written in the order of the objects,
+ * the index at the end. Everything goes in a temporary
+ * file renamed at the end, a reader never sees a half
+ * written file.
+ */
+bool fHistWriter::write(const std::string& filename) const {
+	std::string tmpname = filename + ".tmp";
+	FILE* file = fopen(tmpname.c_str(), "wb");
+	if (file == NULL) {
+		perror("Error opening file\n");
+		return false;
+	}
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.record_size = sizeof(IndexRecord);
+	header.nobjects = h1.size() + h2.size() + profiles.size();
+	fwrite(&header, sizeof(header), 1, file);
+	uint64_t offset = sizeof(header);
+	std::vector<IndexRecord> index;
+	for (const fH1D* h : h1) {
+		IndexRecord rec;
+		memset(&rec, 0, sizeof(rec));
+		copy_name(rec.name, h->getTitle());
+		copy_name(rec.xtitle, h->getXtitle());
+		copy_name(rec.ytitle, h->getYtitle());
+		rec.kind = KIND_H1D;
+		rec.binning = h->getBinning();
+		rec.nbinsx = h->getNumberOfBins();
+		rec.xmin = h->getXmin();
+		rec.xmax = h->getXmax();
+		rec.nEntries = h->getEntries();
+		rec.underflow = h->getUnderflow();
+		rec.overflow = h->getOverflow();
+		rec.sums[0] = h->getSumOfWeights();
+		rec.sums[1] = h->getSum();
+		rec.sums[2] = h->getSum2();
+		const std::vector<double>& edges = h->getEdges();
+		if (!edges.empty()) {
+			rec.edges_offset = offset;
+			fwrite(edges.data(), sizeof(double), edges.size(), file);
+			offset += sizeof(double)*edges.size();
+		}
+		std::vector<double> contents = h->getBinBuffer();
+		rec.contents_offset = offset;
+		fwrite(contents.data(), sizeof(double), contents.size(), file);
+		offset += sizeof(double)*contents.size();
+		if (h->has_quantiles()) {
+			const fTDigest& sketch = h->getQuantileSketch();
+			const std::vector<double>& means = sketch.getMeans();
+			const std::vector<double>& weights = sketch.getWeights();
+			double limits[2] = {sketch.getMin(), sketch.getMax()};
+			rec.sketch_offset = offset;
+			rec.sketch_size = means.size();
+			rec.sketch_compression = sketch.getCompression();
+			fwrite(limits, sizeof(double), 2, file);
+			fwrite(means.data(), sizeof(double), means.size(), file);
+			fwrite(weights.data(), sizeof(double), weights.size(), file);
+			offset += sizeof(double)*(2 + 2*means.size());
+		}
+		index.push_back(rec);
+	}
+	for (const fH2D* h : h2) {
+		IndexRecord rec;
+		memset(&rec, 0, sizeof(rec));
+		copy_name(rec.name, h->getTitle());
+		copy_name(rec.xtitle, h->getXtitle());
+		copy_name(rec.ytitle, h->getYtitle());
+		rec.kind = KIND_H2D;
+		rec.binning = BINNING_UNIFORM;
+		rec.nbinsx = h->getNumberOfBinsX();
+		rec.nbinsy = h->getNumberOfBinsY();
+		rec.xmin = h->getXmin();
+		rec.xmax = h->getXmax();
+		rec.ymin = h->getYmin();
+		rec.ymax = h->getYmax();
+		rec.nEntries = h->getEntries();
+		rec.underflow = h->getOutside();
+		h->getSums(rec.sums);
+		const std::vector<double>& contents = h->getBinBuffer();
+		rec.contents_offset = offset;
+		fwrite(contents.data(), sizeof(double), contents.size(), file);
+		offset += sizeof(double)*contents.size();
+		index.push_back(rec);
+	}
+	for (const fProfile* p : profiles) {
+		IndexRecord rec;
+		memset(&rec, 0, sizeof(rec));
+		copy_name(rec.name, p->getTitle());
+		copy_name(rec.xtitle, p->getXtitle());
+		copy_name(rec.ytitle, p->getYtitle());
+		rec.kind = KIND_PROFILE;
+		rec.binning = BINNING_UNIFORM;
+		rec.nbinsx = p->getNumberOfBins();
+		rec.xmin = p->getXmin();
+		rec.xmax = p->getXmax();
+		rec.nEntries = p->getEntries();
+		rec.underflow = p->getUnderflow();
+		rec.overflow = p->getOverflow();
+		int n = rec.nbinsx;
+		std::vector<double> accumulators(5*n);
+		for (int bin = 0; bin < n; bin++) {
+			accumulators[bin] = p->getBinEntries(bin);
+			accumulators[n + bin] = p->getBinSumOfWeights(bin);
+			accumulators[2*n + bin] = p->getBinSumOfSquaredWeights(bin);
+			accumulators[3*n + bin] = p->getBinMean(bin);
+			accumulators[4*n + bin] = p->getBinM2(bin);
+		}
+		rec.contents_offset = offset;
+		fwrite(accumulators.data(), sizeof(double), accumulators.size(), file);
+		offset += sizeof(double)*accumulators.size();
+		index.push_back(rec);
+	}
+	header.index_offset = offset;
+	fwrite(index.data(), sizeof(IndexRecord), index.size(), file);
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+	bool ok = (ferror(file) == 0);
+	ok = (fclose(file) == 0) && ok;
+	if (!ok || (rename(tmpname.c_str(), filename.c_str()) != 0)) {
+		printf("Error writing %s\n", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+fHistReader::fHistReader(const std::string& filename) : fd(-1), data(nullptr), size(0), header(nullptr), index(nullptr), record_size(0) {
+	fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		perror("Error opening file\n");
+		return ;
+	}
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size < (off_t) sizeof(Header))) {
+		printf("%s is not a histogram file\n", filename.c_str());
+		return ;
+	}
+	size = st.st_size;
+	void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ptr == MAP_FAILED) {
+		perror("Error mapping file\n");
+		return ;
+	}
+	data = (const char*) ptr;
+	const Header* h = (const Header*) data;
+	if ((memcmp(h->magic, magic, sizeof(magic)) != 0) || (h->version > version)) {
+		printf("%s is not a histogram file (or its version is not supported)\n", filename.c_str());
+		return ;
+	}
+	record_size = (h->version == 1) ? record_size_v1 : h->record_size;
+	bool ok = (record_size >= record_size_v1) && (h->index_offset <= size);
+	ok = ok && ((h->nobjects == 0) || ((size - h->index_offset)/h->nobjects >= record_size));
+	if (!ok) {
+		printf("%s is corrupted\n", filename.c_str());
+		return ;
+	}
+	header = h;
+	index = data + header->index_offset;
+}
+
+fHistReader::~fHistReader() {
+	if (data != nullptr) { munmap((void*) data, size);}
+	if (fd >= 0) { close(fd);}
+}
+
+bool fHistReader::is_open() const { return header != nullptr;}
+
+int fHistReader::getNumberOfObjects() const { return is_open() ? header->nobjects : 0;}
+
+std::vector<std::string> fHistReader::getNames() const {
+	std::vector<std::string> names;
+	IndexRecord rec;
+	for (int i = 0; i < getNumberOfObjects(); i++) {
+		getRecord(i, rec);
+		names.push_back(rec.name);
+	}
+	return names;
+}
+
+int fHistReader::find(const std::string& name) const {
+	IndexRecord rec;
+	for (int i = 0; i < getNumberOfObjects(); i++) {
+		getRecord(i, rec);
+		if (strncmp(rec.name, name.c_str(), name_size) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool fHistReader::getRecord(int i, IndexRecord& rec) const {
+	if ((i < 0) || (i >= getNumberOfObjects())) { return false;}
+	memset(&rec, 0, sizeof(rec));
+	memcpy(&rec, index + i*record_size, std::min<uint64_t>(record_size, sizeof(rec)));
+	rec.name[name_size - 1] = '\0';
+	rec.xtitle[name_size - 1] = '\0';
+	rec.ytitle[name_size - 1] = '\0';
+	return true;
+}
+
+/** count doubles from offset are inside the file (no overflow of offset + 8*count) */
+bool fHistReader::in_file(uint64_t offset, uint64_t count) const {
+	return (offset % sizeof(double) == 0) && (offset <= size) && (count <= (size - offset)/sizeof(double));
+}
+
+/**
+ * the arrays of the record are inside the file and the
+ * binning is valid (the histogram built from it has
+ * all its bins) : finite ranges with min < max, xmin > 0
+ * for a logarithmic binning, finite and increasing edges
+ */
+bool fHistReader::check(const IndexRecord& rec) const {
+	auto valid_range = [] (double low, double high) { return std::isfinite(low) && std::isfinite(high) && (low < high);};
+	if (rec.kind == KIND_H1D) {
+		bool ok = (rec.nbinsx > 0) && in_file(rec.contents_offset, rec.nbinsx);
+		ok = ok && ((rec.sketch_offset == 0) || ((rec.sketch_size <= size) && in_file(rec.sketch_offset, 2 + 2*rec.sketch_size)));
+		if (rec.binning == BINNING_VARIABLE) {
+			ok = ok && in_file(rec.edges_offset, (uint64_t) rec.nbinsx + 1);
+			const double* edges = ok ? (const double*) (data + rec.edges_offset) : nullptr;
+			for (int i = 0; ok && (i < rec.nbinsx); i++) {
+				ok = valid_range(edges[i], edges[i+1]);
+			}
+			return ok;
+		}
+		return ok && valid_range(rec.xmin, rec.xmax) && ((rec.binning != BINNING_LOG) || (rec.xmin > 0));
+	}
+	if (rec.kind == KIND_H2D) {
+		return (rec.nbinsx > 0) && (rec.nbinsy > 0) && in_file(rec.contents_offset, ((uint64_t) rec.nbinsx)*rec.nbinsy)
+			&& valid_range(rec.xmin, rec.xmax) && valid_range(rec.ymin, rec.ymax);
+	}
+	if (rec.kind == KIND_PROFILE) {
+		return (rec.nbinsx > 0) && in_file(rec.contents_offset, 5*((uint64_t) rec.nbinsx)) && valid_range(rec.xmin, rec.xmax);
+	}
+	return false;
+}
+
+const double* fHistReader::getContents(int i) const {
+	IndexRecord rec;
+	if (!getRecord(i, rec) || !check(rec)) { return nullptr;}
+	return (const double*) (data + rec.contents_offset);
+}
+
+std::unique_ptr<fH1D> fHistReader::getH1D(const std::string& name) const { return getH1D(find(name));}
+std::unique_ptr<fH2D> fHistReader::getH2D(const std::string& name) const { return getH2D(find(name));}
+std::unique_ptr<fProfile> fHistReader::getProfile(const std::string& name) const { return getProfile(find(name));}
+
+std::unique_ptr<fH1D> fHistReader::getH1D(int i) const {
+	IndexRecord rec;
+	if (!getRecord(i, rec) || (rec.kind != KIND_H1D)) { return nullptr;}
+	if (!check(rec)) {
+		printf("fHistReader : %s is corrupted\n", rec.name);
+		return nullptr;
+	}
+	std::unique_ptr<fH1D> h;
+	if (rec.binning == BINNING_VARIABLE) {
+		const double* edges = (const double*) (data + rec.edges_offset);
+		h.reset(new fH1D(rec.name, std::vector<double>(edges, edges + rec.nbinsx + 1)));
+	}
+	else {
+		h.reset(new fH1D(rec.name, rec.nbinsx, rec.xmin, rec.xmax, rec.binning == BINNING_LOG));
+	}
+	h->set_xtitle(rec.xtitle);
+	h->set_ytitle(rec.ytitle);
+	const double* contents = (const double*) (data + rec.contents_offset);
+	for (int bin = 0; bin < rec.nbinsx; bin++) {
+		h->set_bin_content(bin, contents[bin]);
+	}
+	h->set_stats(rec.nEntries, rec.underflow, rec.overflow, rec.sums[0], rec.sums[1], rec.sums[2]);
+	if (rec.sketch_offset != 0) {
+		const double* sketch = (const double*) (data + rec.sketch_offset);
+		const double* means = sketch + 2;
+		const double* weights = means + rec.sketch_size;
+		h->enable_quantiles(rec.sketch_compression);
+		h->getQuantileSketch().set_centroids(std::vector<double>(means, means + rec.sketch_size), std::vector<double>(weights, weights + rec.sketch_size), sketch[0], sketch[1]);
+	}
+	return h;
+}
+
+std::unique_ptr<fH2D> fHistReader::getH2D(int i) const {
+	IndexRecord rec;
+	if (!getRecord(i, rec) || (rec.kind != KIND_H2D)) { return nullptr;}
+	if (!check(rec)) {
+		printf("fHistReader : %s is corrupted\n", rec.name);
+		return nullptr;
+	}
+	std::unique_ptr<fH2D> h(new fH2D(rec.name, rec.nbinsx, rec.xmin, rec.xmax, rec.nbinsy, rec.ymin, rec.ymax));
+	h->set_xtitle(rec.xtitle);
+	h->set_ytitle(rec.ytitle);
+	const double* contents = (const double*) (data + rec.contents_offset);
+	for (int iy = 0; iy < rec.nbinsy; iy++) {
+		for (int ix = 0; ix < rec.nbinsx; ix++) {
+			h->set_bin_content(ix, iy, contents[iy*rec.nbinsx + ix]);
+		}
+	}
+	h->set_stats(rec.nEntries, rec.underflow, rec.sums);
+	return h;
+}
+
+std::unique_ptr<fProfile> fHistReader::getProfile(int i) const {
+	IndexRecord rec;
+	if (!getRecord(i, rec) || (rec.kind != KIND_PROFILE)) { return nullptr;}
+	if (!check(rec)) {
+		printf("fHistReader : %s is corrupted\n", rec.name);
+		return nullptr;
+	}
+	std::unique_ptr<fProfile> p(new fProfile(rec.name, rec.nbinsx, rec.xmin, rec.xmax));
+	p->set_xtitle(rec.xtitle);
+	p->set_ytitle(rec.ytitle);
+	int n = rec.nbinsx;
+	const double* accumulators = (const double*) (data + rec.contents_offset);
+	for (int bin = 0; bin < n; bin++) {
+		double entries = accumulators[bin];
+		entries = ((entries > 0) && (entries < 1e19)) ? entries : 0; // also nan, before the conversion
+		p->set_bin(bin, entries, accumulators[n + bin], accumulators[2*n + bin], accumulators[3*n + bin], accumulators[4*n + bin]);
+	}
+	p->set_outside(rec.underflow, rec.overflow);
+	return p;
+}
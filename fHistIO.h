@@ -0,0 +1,135 @@
+/***********************************************
+ * Binary file for many histograms (fH1D, fH2D,
+ * fProfile)
+ *
+ * Layout (native byte order, little endian on
+ * our machines) :
+ *   - header : magic, version, number of objects,
+ *     position of the index
+ *   - data : bin edges and contents of each
+ *     object, aligned on 8 bytes
+ *   - index : one fixed-size record per object
+ *     (name, binning, statistics, positions of
+ *     the data)
+ *
+ * Version 2 : fH1D quantile sketches (t-digest
+ * centroids) are stored with the data, the size
+ * of an index record is given in the header.
+ * A fProfile record (kind 3) points to the 5
+ * arrays of its accumulators : entries, sum of
+ * weights, sum of squared weights, mean and M2
+ * (sum of w*(y - mean)^2) of each bin, so that
+ * the profiles of the shards can be merged.
+ *
+ * The reader maps the file in memory and only
+ * touches the index when it is opened, a
+ * histogram is read when it is requested.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_HIST_IO_H
+#define F_HIST_IO_H
+
+#include "fH1D.h"
+#include "fH2D.h"
+#include "fProfile.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace fHistIO {
+	const char magic[8] = {'f', 'H', 'I', 'S', 'T', 'I', 'O', '\0'};
+	const uint32_t version = 2;
+	const uint64_t record_size_v1 = 328; ///< size of an index record in version 1
+	const int name_size = 64; ///< maximum size of the names and titles (with the final \0)
+
+	enum Kind : uint32_t {
+		KIND_H1D = 1,
+		KIND_H2D = 2,
+		KIND_PROFILE = 3
+	};
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t nobjects;
+		uint64_t index_offset; ///< position of the first index record
+		uint64_t record_size; ///< size of an index record (0 in version 1)
+		uint64_t reserved[4];
+	};
+
+	struct IndexRecord {
+		char name[name_size];
+		char xtitle[name_size];
+		char ytitle[name_size];
+		uint32_t kind; ///< see Kind
+		uint32_t binning; ///< see fBinning (fH1D only)
+		int32_t nbinsx;
+		int32_t nbinsy; ///< 0 for a fH1D
+		double xmin;
+		double xmax;
+		double ymin;
+		double ymax;
+		uint64_t nEntries;
+		uint64_t underflow; ///< underflow for a fH1D and a fProfile, entries outside for a fH2D
+		uint64_t overflow;
+		double sums[6]; ///< fH1D : sumw, sum, sum2 / fH2D : sumw, sumx, sumx2, sumy, sumy2, sumxy
+		uint64_t edges_offset; ///< 0 if the binning is uniform
+		uint64_t contents_offset; ///< fProfile : entries, sumw, sumw2, mean, m2 (nbinsx each)
+		// version 2
+		uint64_t sketch_offset; ///< min, max, means and weights of the centroids, 0 if no sketch
+		uint64_t sketch_size; ///< number of centroids
+		double sketch_compression;
+	};
+}
+
+/**
+ * Collect the histograms to write, write() can be
+ * called again later (e.g periodic checkpoints)
+ */
+class fHistWriter {
+private :
+	std::vector<const fH1D*> h1;
+	std::vector<const fH2D*> h2;
+	std::vector<const fProfile*> profiles;
+	bool has_name(const std::string& name) const; ///< compared on the name_size - 1 characters written
+public :
+	bool add(const fH1D* h); ///< false if the name is already used (the histograms are found by name)
+	bool add(const fH2D* h);
+	bool add(const fProfile* p);
+	bool write(const std::string& filename) const; ///< written in filename.tmp then renamed (atomic)
+};
+
+class fHistReader {
+private :
+	int fd; ///< file descriptor
+	const char* data; ///< mapped file
+	size_t size; ///< size of the file
+	const fHistIO::Header* header;
+	const char* index; ///< first index record
+	uint64_t record_size; ///< size of an index record in this file
+	bool in_file(uint64_t offset, uint64_t count) const;
+	bool check(const fHistIO::IndexRecord& rec) const; ///< the arrays of the record are inside the file
+public :
+	fHistReader(const std::string& filename);
+	~fHistReader();
+	fHistReader(const fHistReader&) = delete;
+	fHistReader& operator=(const fHistReader&) = delete;
+	bool is_open() const;
+	int getNumberOfObjects() const;
+	std::vector<std::string> getNames() const;
+	int find(const std::string& name) const; ///< position in the index, -1 if not found
+	bool getRecord(int i, fHistIO::IndexRecord& rec) const; ///< fields missing in older versions are set to 0, the names end with \0
+	const double* getContents(int i) const; ///< pointer in the mapped file, no copy, nullptr if corrupted
+	std::unique_ptr<fH1D> getH1D(const std::string& name) const; ///< nullptr if not found or corrupted
+	std::unique_ptr<fH2D> getH2D(const std::string& name) const; ///< nullptr if not found or corrupted
+	std::unique_ptr<fH1D> getH1D(int i) const; ///< i-th object of the index
+	std::unique_ptr<fH2D> getH2D(int i) const;
+	std::unique_ptr<fProfile> getProfile(const std::string& name) const; ///< nullptr if not found or corrupted
+	std::unique_ptr<fProfile> getProfile(int i) const;
+};
+
+#endif
@@ -0,0 +1,200 @@
+/***********************************************
+ * Vectorized kernels on batches of waveforms
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fKernels.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define F_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+static const int nsamples = fWaveformBatch::nsamples;
+
+void fWaveformStats::resize(int nhits) {
+	length.resize(nhits);
+	pedestal.resize(nhits);
+	sumsq.resize(nhits);
+	peak.resize(nhits);
+	peak_pos.resize(nhits);
+}
+
+double fWaveformStats::getRms(int hit) const {
+	return sqrt(((double) sumsq[hit])/length[hit]);
+}
+
+/**
+ * hits [first, last[, by blocks of 64 hits read sample by
+ * sample (contiguous memory), the accumulators of a block
+ * stay in the L1 cache
+ */
+static void stats_scalar(const int16_t* samples, int stride, int first, int last, fWaveformStats& stats) {
+	const int block = 64;
+	for (int h0 = first; h0 < last; h0 += block) {
+		int m = std::min(block, last - h0);
+		int16_t len[block], vmax[block], pos[block];
+		int64_t sum[block];
+		for (int i = 0; i < m; i++) {
+			len[i] = 0;
+			vmax[i] = samples[h0 + i];
+			pos[i] = 0;
+			sum[i] = 0;
+		}
+		for (int s = 0; s < nsamples; s++) {
+			const int16_t* x = samples + s*stride + h0;
+			#pragma omp simd
+			for (int i = 0; i < m; i++) {
+				len[i] = (x[i] != 0) ? s + 1 : len[i];
+				pos[i] = (x[i] > vmax[i]) ? s : pos[i];
+				vmax[i] = (x[i] > vmax[i]) ? x[i] : vmax[i];
+				sum[i] += x[i]*x[i];
+			}
+		}
+		for (int i = 0; i < m; i++) {
+			stats.length[h0 + i] = (len[i] == 0) ? nsamples : len[i];
+			stats.pedestal[h0 + i] = samples[h0 + i];
+			stats.sumsq[h0 + i] = sum[i];
+			stats.peak[h0 + i] = vmax[i];
+			stats.peak_pos[h0 + i] = pos[i];
+		}
+	}
+}
+
+#ifdef F_KERNELS_X86
+
+/** 16 hits per iteration, the squares are summed on 64 bits */
+__attribute__((target("avx2")))
+static int stats_avx2(const int16_t* samples, int stride, int nhits, fWaveformStats& stats) {
+	const __m256i zero = _mm256_setzero_si256();
+	int h = 0;
+	for (; h + 16 <= nhits; h += 16) {
+		__m256i len = zero;
+		__m256i vmax = _mm256_loadu_si256((const __m256i*) (samples + h));
+		__m256i pos = zero;
+		__m256i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+		for (int s = 0; s < nsamples; s++) {
+			__m256i x = _mm256_loadu_si256((const __m256i*) (samples + s*stride + h));
+			// last non zero sample
+			len = _mm256_blendv_epi8(_mm256_set1_epi16(s + 1), len, _mm256_cmpeq_epi16(x, zero));
+			// first largest sample
+			pos = _mm256_blendv_epi8(pos, _mm256_set1_epi16(s), _mm256_cmpgt_epi16(x, vmax));
+			vmax = _mm256_max_epi16(vmax, x);
+			// squares
+			__m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x));
+			__m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1));
+			lo = _mm256_mullo_epi32(lo, lo);
+			hi = _mm256_mullo_epi32(hi, hi);
+			sum0 = _mm256_add_epi64(sum0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(lo)));
+			sum1 = _mm256_add_epi64(sum1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(lo, 1)));
+			sum2 = _mm256_add_epi64(sum2, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(hi)));
+			sum3 = _mm256_add_epi64(sum3, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(hi, 1)));
+		}
+		len = _mm256_blendv_epi8(len, _mm256_set1_epi16(nsamples), _mm256_cmpeq_epi16(len, zero));
+		_mm256_storeu_si256((__m256i*) (stats.length.data() + h), len);
+		_mm256_storeu_si256((__m256i*) (stats.pedestal.data() + h), _mm256_loadu_si256((const __m256i*) (samples + h)));
+		_mm256_storeu_si256((__m256i*) (stats.peak.data() + h), vmax);
+		_mm256_storeu_si256((__m256i*) (stats.peak_pos.data() + h), pos);
+		_mm256_storeu_si256((__m256i*) (stats.sumsq.data() + h), sum0);
+		_mm256_storeu_si256((__m256i*) (stats.sumsq.data() + h + 4), sum1);
+		_mm256_storeu_si256((__m256i*) (stats.sumsq.data() + h + 8), sum2);
+		_mm256_storeu_si256((__m256i*) (stats.sumsq.data() + h + 12), sum3);
+	}
+	return h;
+}
+
+/** 8 hits per iteration */
+__attribute__((target("sse4.1")))
+static int stats_sse41(const int16_t* samples, int stride, int nhits, fWaveformStats& stats) {
+	const __m128i zero = _mm_setzero_si128();
+	int h = 0;
+	for (; h + 8 <= nhits; h += 8) {
+		__m128i len = zero;
+		__m128i vmax = _mm_loadu_si128((const __m128i*) (samples + h));
+		__m128i pos = zero;
+		__m128i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+		for (int s = 0; s < nsamples; s++) {
+			__m128i x = _mm_loadu_si128((const __m128i*) (samples + s*stride + h));
+			len = _mm_blendv_epi8(_mm_set1_epi16(s + 1), len, _mm_cmpeq_epi16(x, zero));
+			pos = _mm_blendv_epi8(pos, _mm_set1_epi16(s), _mm_cmpgt_epi16(x, vmax));
+			vmax = _mm_max_epi16(vmax, x);
+			__m128i lo = _mm_cvtepi16_epi32(x);
+			__m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(x, 8));
+			lo = _mm_mullo_epi32(lo, lo);
+			hi = _mm_mullo_epi32(hi, hi);
+			sum0 = _mm_add_epi64(sum0, _mm_cvtepi32_epi64(lo));
+			sum1 = _mm_add_epi64(sum1, _mm_cvtepi32_epi64(_mm_srli_si128(lo, 8)));
+			sum2 = _mm_add_epi64(sum2, _mm_cvtepi32_epi64(hi));
+			sum3 = _mm_add_epi64(sum3, _mm_cvtepi32_epi64(_mm_srli_si128(hi, 8)));
+		}
+		len = _mm_blendv_epi8(len, _mm_set1_epi16(nsamples), _mm_cmpeq_epi16(len, zero));
+		_mm_storeu_si128((__m128i*) (stats.length.data() + h), len);
+		_mm_storeu_si128((__m128i*) (stats.pedestal.data() + h), _mm_loadu_si128((const __m128i*) (samples + h)));
+		_mm_storeu_si128((__m128i*) (stats.peak.data() + h), vmax);
+		_mm_storeu_si128((__m128i*) (stats.peak_pos.data() + h), pos);
+		_mm_storeu_si128((__m128i*) (stats.sumsq.data() + h), sum0);
+		_mm_storeu_si128((__m128i*) (stats.sumsq.data() + h + 2), sum1);
+		_mm_storeu_si128((__m128i*) (stats.sumsq.data() + h + 4), sum2);
+		_mm_storeu_si128((__m128i*) (stats.sumsq.data() + h + 6), sum3);
+	}
+	return h;
+}
+
+#endif
+
+fKernels::Isa fKernels::getBestIsa() {
+#ifdef F_KERNELS_X86
+	static const Isa best = __builtin_cpu_supports("avx2") ? ISA_AVX2 : (__builtin_cpu_supports("sse4.1") ? ISA_SSE41 : ISA_SCALAR);
+	return best;
+#else
+	return ISA_SCALAR;
+#endif
+}
+
+const char* fKernels::getIsaName(Isa isa) {
+	switch (isa) {
+		case ISA_AVX2 : return "avx2";
+		case ISA_SSE41 : return "sse4.1";
+		default : return "scalar";
+	}
+}
+
+void fKernels::waveform_stats(const int16_t* samples, int stride, int nhits, fWaveformStats& stats, Isa isa) {
+	if ((int) stats.length.size() < nhits) { stats.resize(nhits);}
+	isa = (isa > getBestIsa()) ? getBestIsa() : isa;
+	int done = 0; // hits done by the vector variant, the others by the scalar one
+#ifdef F_KERNELS_X86
+	if (isa == ISA_AVX2) { done = stats_avx2(samples, stride, nhits, stats);}
+	else if (isa == ISA_SSE41) { done = stats_sse41(samples, stride, nhits, stats);}
+#endif
+	stats_scalar(samples, stride, done, nhits, stats);
+}
+
+void fKernels::waveform_stats(const int16_t* samples, int stride, int nhits, fWaveformStats& stats) {
+	waveform_stats(samples, stride, nhits, stats, getBestIsa());
+}
+
+void fKernels::waveform_stats(const fWaveformBatch& batch, fWaveformStats& stats) {
+	waveform_stats(batch.getSamples(0), batch.getStride(), batch.getNumberOfHits(), stats, getBestIsa());
+}
+
+/** the compiler vectorizes the loop over the hits (-fopenmp-simd) */
+void fKernels::subtract_pedestals(const int16_t* samples, int stride, int nhits, const float* pedestals, float* corrected) {
+	for (int s = 0; s < nsamples; s++) {
+		const int16_t* x = samples + s*stride;
+		float* c = corrected + s*stride;
+		#pragma omp simd
+		for (int h = 0; h < nhits; h++) {
+			c[h] = x[h] - pedestals[h];
+		}
+	}
+}
+
+void fKernels::subtract_pedestals(const fWaveformBatch& batch, const float* pedestals, fAlignedVector<float>& corrected) {
+	if ((int) corrected.size() < nsamples*batch.getStride()) { corrected.resize(nsamples*batch.getStride());}
+	subtract_pedestals(batch.getSamples(0), batch.getStride(), batch.getNumberOfHits(), pedestals, corrected.data());
+}
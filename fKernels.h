@@ -0,0 +1,67 @@
+/***********************************************
+ * Vectorized kernels on batches of waveforms
+ *
+ * The waveforms are stored sample by sample (see
+ * fWaveformBatch) : a vector register holds the
+ * same sample of 16 (AVX2) or 8 (SSE4.1) hits.
+ * The variant is chosen at run time from the
+ * instructions supported by the processor, a
+ * scalar version is used otherwise.
+ *
+ * The results are exact (integer arithmetic) and
+ * identical for all the variants.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_KERNELS_H
+#define F_KERNELS_H
+
+#include "fWaveformBatch.h"
+#include <cstdint>
+
+/** results of fKernels::waveform_stats, one entry per hit */
+struct fWaveformStats {
+	fAlignedVector<int16_t> length; ///< number of samples before the trailing zeros, 50 if all are 0
+	fAlignedVector<int16_t> pedestal; ///< first sample
+	fAlignedVector<int64_t> sumsq; ///< sum of the squared samples
+	fAlignedVector<int16_t> peak; ///< largest sample
+	fAlignedVector<int16_t> peak_pos; ///< position of the first largest sample
+	void resize(int nhits);
+	double getRms(int hit) const; ///< sqrt(sumsq/length), as in rms.cpp
+};
+
+namespace fKernels {
+	enum Isa {
+		ISA_SCALAR,
+		ISA_SSE41,
+		ISA_AVX2
+	};
+
+	Isa getBestIsa(); ///< best variant supported by this processor
+	const char* getIsaName(Isa isa);
+
+	/**
+	 * length, pedestal, sum of squares, peak value and position
+	 * of nhits waveforms of 50 samples, in one pass
+	 *
+	 * @param samples sample s of hit h at samples[s*stride + h]
+	 * @param isa variant (by default the best one), a variant not
+	 * supported by the processor is replaced by the best one
+	 */
+	void waveform_stats(const int16_t* samples, int stride, int nhits, fWaveformStats& stats, Isa isa);
+	void waveform_stats(const int16_t* samples, int stride, int nhits, fWaveformStats& stats);
+	void waveform_stats(const fWaveformBatch& batch, fWaveformStats& stats);
+
+	/**
+	 * pedestal corrected samples, in the same layout :
+	 * corrected[s*stride + h] = samples[s*stride + h] - pedestals[h]
+	 *
+	 * @param pedestals one per hit, e.g fCalibration::getPedestals
+	 */
+	void subtract_pedestals(const int16_t* samples, int stride, int nhits, const float* pedestals, float* corrected);
+	void subtract_pedestals(const fWaveformBatch& batch, const float* pedestals, fAlignedVector<float>& corrected);
+}
+
+#endif
@@ -0,0 +1,361 @@
+/***********************************************
+ * Data quality modules
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fModule.h"
+#include "fChannelMap.h"
+
+#include <cstdio>
+#include <algorithm>
+
+#include <cairommconfig.h>
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+
+/** one page per histogram */
+static void print_pdf(std::string filename, std::vector<fH1D*> hists) {
+	int width = 1400;
+	int height = 800;
+	auto surface = Cairo::PdfSurface::create(filename, width, height);
+	auto cr = Cairo::Context::create(surface);
+	for (fH1D* h : hists) {
+		h->draw_with_cairo(cr, width, height);
+		cr->show_page();
+	}
+	printf("   > %s\n", filename.c_str());
+}
+
+/******************
+ * fModuleList
+ ******************/
+
+fModuleList::fModuleList(const fModuleList& other) {
+	for (const std::unique_ptr<fModule>& module : other.modules) {
+		modules.emplace_back(module->clone());
+	}
+}
+
+fModuleList& fModuleList::operator=(const fModuleList& other) {
+	if (this != &other) {
+		modules.clear();
+		for (const std::unique_ptr<fModule>& module : other.modules) {
+			modules.emplace_back(module->clone());
+		}
+	}
+	return *this;
+}
+
+void fModuleList::add(fModule* module) { modules.emplace_back(module);}
+
+void fModuleList::add(std::string name, fPipeline& pipeline) {
+	if      (name == "cosmics") { add(new fCosmicsModule(pipeline));}
+	else if (name == "noise")   { add(new fNoiseModule(pipeline));}
+	else if (name == "rms")     { add(new fRmsModule(pipeline));}
+	else if (name == "time")    { add(new fTimeModule(pipeline));}
+}
+
+std::vector<std::string> fModuleList::getModuleNames() { return {"cosmics", "noise", "rms", "time"};}
+
+bool fModuleList::add_columns(const std::vector<std::string>& names, std::vector<fColumns>& projection) {
+	for (std::string name : names) {
+		if      (name == "cosmics") { fPipeline::add_columns(projection, fCosmicsModule::getColumns());}
+		else if (name == "noise")   { fPipeline::add_columns(projection, fNoiseModule::getColumns());}
+		else if (name == "rms")     { fPipeline::add_columns(projection, fRmsModule::getColumns());}
+		else if (name == "time")    { fPipeline::add_columns(projection, fTimeModule::getColumns());}
+		else {
+			printf("Unknown module : %s\n", name.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+int fModuleList::size() const { return modules.size();}
+fModule& fModuleList::operator[](int i) { return *modules[i];}
+
+void fModuleList::process(hipo::banklist& banks, long nEvent) {
+	for (std::unique_ptr<fModule>& module : modules) {
+		module->process(banks, nEvent);
+	}
+}
+
+void fModuleList::flush() {
+	for (std::unique_ptr<fModule>& module : modules) {
+		module->flush();
+	}
+}
+
+void fModuleList::merge(const fModuleList& other) {
+	for (int i = 0; i < (int) modules.size(); i++) {
+		modules[i]->merge(*other.modules[i]);
+	}
+}
+
+void fModuleList::finish(std::string prefix) {
+	for (std::unique_ptr<fModule>& module : modules) {
+		printf("===== %s =====\n", module->getName().c_str());
+		module->finish(prefix);
+	}
+}
+
+void fModuleList::save(fHistWriter& writer) const {
+	for (const std::unique_ptr<fModule>& module : modules) {
+		module->save(writer);
+	}
+}
+
+void fModuleList::summary(std::vector<std::string>& names, std::vector<double>& values) const {
+	for (const std::unique_ptr<fModule>& module : modules) {
+		module->summary(names, values);
+	}
+}
+
+/******************
+ * fCosmicsModule
+ ******************/
+
+fCosmicsModule::fCosmicsModule(fPipeline& pipeline) {
+	bank = pipeline.getBankIndex("AHDC::adc");
+	item_layer = pipeline.getColumn(bank, "layer");
+}
+
+fColumns fCosmicsModule::getColumns() { return {"AHDC::adc", {"layer"}};}
+
+std::string fCosmicsModule::getName() const { return "cosmics";}
+fModule* fCosmicsModule::clone() const { return new fCosmicsModule(*this);}
+
+void fCosmicsModule::process(hipo::banklist& banks, long nEvent) {
+	hipo::bank& adc = banks[bank];
+	int flags = 0; // bit i : hit in the layer fChannelMap::getLayerCode(i)
+	for (int col = 0; col < adc.getRows(); col++) {
+		int i = fChannelMap::getLayerIndex(adc.getInt(item_layer, col));
+		flags |= (i >= 0) ? (1 << i) : 0;
+	}
+	if (flags == (1 << fChannelMap::nlayers) - 1) {
+		events.push_back(nEvent + 1);
+	}
+}
+
+void fCosmicsModule::merge(const fModule& other) {
+	const fCosmicsModule& module = static_cast<const fCosmicsModule&>(other);
+	events.insert(events.end(), module.events.begin(), module.events.end());
+}
+
+void fCosmicsModule::finish(std::string prefix) {
+	std::sort(events.begin(), events.end());
+	for (long nEvent : events) {
+		printf(" ---> nEvent : %ld\n", nEvent);
+	}
+	printf("nEvents with a hit in the 8 layers : %ld\n", (long) events.size());
+}
+
+void fCosmicsModule::summary(std::vector<std::string>& names, std::vector<double>& values) const {
+	names.push_back("cosmics");
+	values.push_back(events.size());
+}
+
+/******************
+ * fNoiseModule
+ ******************/
+
+fNoiseModule::fNoiseModule(fPipeline& pipeline) {
+	bank = pipeline.getBankIndex("AHDC::wf");
+	item_layer = pipeline.getColumn(bank, "layer");
+}
+
+fColumns fNoiseModule::getColumns() { return {"AHDC::wf", {"layer"}};}
+
+std::string fNoiseModule::getName() const { return "noise";}
+fModule* fNoiseModule::clone() const { return new fNoiseModule(*this);}
+
+void fNoiseModule::process(hipo::banklist& banks, long nEvent) {
+	hipo::bank& wf = banks[bank];
+	int nhit_layer[fChannelMap::nlayers] = {0};
+	for (int col = 0; col < wf.getRows(); col++) {
+		int i = fChannelMap::getLayerIndex(wf.getInt(item_layer, col));
+		if (i >= 0) { nhit_layer[i]++;}
+	}
+	int nhit_51 = nhit_layer[fChannelMap::getLayerIndex(51)];
+	int nhit_42 = nhit_layer[fChannelMap::getLayerIndex(42)];
+	int nhit = nhit_51 + nhit_42;
+	if (nhit > 150) { // 99 + 87 == 186
+		nEvent_full++;
+		lines.push_back({nEvent+1, nhit, nhit_51, nhit_42});
+	}
+	else if ((nhit > 80) && (nhit <= 150)) {
+		nEvent_semi++;
+		lines.push_back({nEvent+1, nhit, nhit_51, nhit_42});
+	}
+	else if ((nhit > 20) && (nhit <= 80)) {
+		nEvent_semi_semi++;
+		lines.push_back({nEvent+1, nhit, nhit_51, nhit_42});
+	}
+}
+
+void fNoiseModule::merge(const fModule& other) {
+	const fNoiseModule& module = static_cast<const fNoiseModule&>(other);
+	nEvent_full += module.nEvent_full;
+	nEvent_semi += module.nEvent_semi;
+	nEvent_semi_semi += module.nEvent_semi_semi;
+	lines.insert(lines.end(), module.lines.begin(), module.lines.end());
+}
+
+void fNoiseModule::finish(std::string prefix) {
+	std::sort(lines.begin(), lines.end());
+	for (const std::vector<long>& line : lines) {
+		long nhit = line[1];
+		const char* color = (nhit > 150) ? "\033[31m" : ((nhit > 80) ? "\033[33m" : "\033[32m");
+		printf("%s   > nEvent : %5ld, nhit : %3ld, nhit_51 : %3ld, nhit_42 : %3ld\n\033[0m", color, line[0], nhit, line[2], line[3]);
+	}
+	printf("\033[31m nEvent_full       : %ld\n\033[0m", nEvent_full);
+	printf("\033[33m nEvent_semi       : %ld\n\033[0m", nEvent_semi);
+	printf("\033[32m nEvent_semi_semi  : %ld\n\033[0m", nEvent_semi_semi);
+}
+
+void fNoiseModule::summary(std::vector<std::string>& names, std::vector<double>& values) const {
+	names.insert(names.end(), {"noise_full", "noise_semi", "noise_semi_semi"});
+	values.insert(values.end(), {(double) nEvent_full, (double) nEvent_semi, (double) nEvent_semi_semi});
+}
+
+/******************
+ * fRmsModule
+ ******************/
+
+fRmsModule::fRmsModule(fPipeline& pipeline) : bank(pipeline.getBankIndex("AHDC::wf")), prof_rms("Mean RMS per wire", fChannelMap::nchannels, 0, fChannelMap::nchannels), batch(pipeline.getBank(bank).getSchema()) {
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		char title[50];
+		sprintf(title, "RMS signals in Layer %d", fChannelMap::getLayerCode(i));
+		hist1d_rms.push_back(fH1D(title, 100, 0, 500));
+		hist1d_rms[i].set_xtitle("RMS");
+		hist1d_rms[i].set_ytitle("Count");
+	}
+	prof_rms.set_xtitle("wire number (layers 11 to 51)");
+	prof_rms.set_ytitle("RMS");
+}
+
+fColumns fRmsModule::getColumns() { return {"AHDC::wf", fWaveformBatch::getColumns()};}
+
+std::string fRmsModule::getName() const { return "rms";}
+fModule* fRmsModule::clone() const { return new fRmsModule(*this);}
+
+void fRmsModule::process(hipo::banklist& banks, long nEvent) {
+	batch.add_event(banks[bank], nEvent);
+}
+
+void fRmsModule::flush() {
+	fKernels::waveform_stats(batch, stats);
+	for (int hit = 0; hit < batch.getNumberOfHits(); hit++) {
+		int wire = fChannelMap::getChannel(batch.getLayers()[hit], batch.getComponents()[hit]);
+		if (wire < 0) { continue;}
+		double rms = stats.getRms(hit);
+		prof_rms.fill_bins(&wire, &rms, 1);
+		hist1d_rms[fChannelMap::getLayerIndexOfChannel(wire)].fill(rms);
+	}
+	batch.clear();
+}
+
+void fRmsModule::merge(const fModule& other) {
+	const fRmsModule& module = static_cast<const fRmsModule&>(other);
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		hist1d_rms[i].merge(module.hist1d_rms[i]);
+	}
+	prof_rms.merge(module.prof_rms);
+}
+
+void fRmsModule::finish(std::string prefix) {
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		printf("   layer %d : %ld signals, mean RMS %lf\n", fChannelMap::getLayerCode(i), hist1d_rms[i].getEntries(), hist1d_rms[i].getMean());
+	}
+	std::vector<fH1D*> hists;
+	for (fH1D& h : hist1d_rms) {
+		hists.push_back(&h);
+	}
+	print_pdf(prefix + "_rms.pdf", hists);
+	int width = 1400;
+	int height = 800;
+	auto surface = Cairo::PdfSurface::create(prefix + "_rms_profile.pdf", width, height);
+	auto cr = Cairo::Context::create(surface);
+	prof_rms.set_error_mode(PROFILE_ERROR_SPREAD);
+	prof_rms.draw_with_cairo(cr, width, height);
+	cr->show_page();
+	printf("   > %s\n", (prefix + "_rms_profile.pdf").c_str());
+}
+
+void fRmsModule::save(fHistWriter& writer) const {
+	for (const fH1D& h : hist1d_rms) {
+		writer.add(&h);
+	}
+	writer.add(&prof_rms);
+}
+
+void fRmsModule::summary(std::vector<std::string>& names, std::vector<double>& values) const {
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		names.push_back("rms_" + std::to_string(fChannelMap::getLayerCode(i)));
+		values.push_back(hist1d_rms[i].getMean());
+	}
+}
+
+/******************
+ * fTimeModule
+ ******************/
+
+fTimeModule::fTimeModule(fPipeline& pipeline) : hist1d_time("time of the hits", 100, 0, 5000) {
+	bank = pipeline.getBankIndex("AHDC::adc");
+	item_layer = pipeline.getColumn(bank, "layer");
+	item_time = pipeline.getColumn(bank, "time");
+	hist1d_time.set_xtitle("time");
+	hist1d_time.set_ytitle("count");
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		char title[50];
+		sprintf(title, "time of the hits in Layer %d", fChannelMap::getLayerCode(i));
+		hist1d_time_layer.push_back(fH1D(title, 100, 0, 5000));
+		hist1d_time_layer[i].set_xtitle("time");
+		hist1d_time_layer[i].set_ytitle("count");
+	}
+}
+
+fColumns fTimeModule::getColumns() { return {"AHDC::adc", {"layer", "time"}};}
+
+std::string fTimeModule::getName() const { return "time";}
+fModule* fTimeModule::clone() const { return new fTimeModule(*this);}
+
+void fTimeModule::process(hipo::banklist& banks, long nEvent) {
+	hipo::bank& adc = banks[bank];
+	for (int col = 0; col < adc.getRows(); col++) {
+		double time = adc.getInt(item_time, col);
+		hist1d_time.fill(time);
+		int i = fChannelMap::getLayerIndex(adc.getInt(item_layer, col));
+		if (i >= 0) { hist1d_time_layer[i].fill(time);}
+	}
+}
+
+void fTimeModule::merge(const fModule& other) {
+	const fTimeModule& module = static_cast<const fTimeModule&>(other);
+	hist1d_time.merge(module.hist1d_time);
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		hist1d_time_layer[i].merge(module.hist1d_time_layer[i]);
+	}
+}
+
+void fTimeModule::finish(std::string prefix) {
+	printf("   %ld hits, mean time %lf\n", hist1d_time.getEntries(), hist1d_time.getMean());
+	std::vector<fH1D*> hists = {&hist1d_time};
+	for (fH1D& h : hist1d_time_layer) {
+		hists.push_back(&h);
+	}
+	print_pdf(prefix + "_time.pdf", hists);
+}
+
+void fTimeModule::save(fHistWriter& writer) const {
+	writer.add(&hist1d_time);
+	for (const fH1D& h : hist1d_time_layer) {
+		writer.add(&h);
+	}
+}
+
+void fTimeModule::summary(std::vector<std::string>& names, std::vector<double>& values) const {
+	names.push_back("time");
+	values.push_back(hist1d_time.getMean());
+}
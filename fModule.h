@@ -0,0 +1,158 @@
+/***********************************************
+ * Data quality modules
+ *
+ * A module is one of the studies of the analysis
+ * executables (hits, noise_count, rms,
+ * first_channel), written so that several of them
+ * run in the same pass over the file : the events
+ * are read and decompressed once (see fPipeline)
+ * and the decoded banks are given to all the
+ * modules of a fModuleList. Each module declares
+ * the columns it reads (getColumns) : only the
+ * banks used by the selected modules are read.
+ *
+ * A fModuleList is the state of the pipeline :
+ * each thread has its own copy of the modules
+ * (clone), merged at the end (merge) before the
+ * results are printed and drawn (finish). The
+ * histograms are also saved (save) in a file that
+ * can be merged with the ones of the other shards
+ * (see hmerge.cpp).
+ *
+ * e.g (see dq.cpp)
+ *     fPipeline pipeline(filename, {fTimeModule::getColumns()});
+ *     fModuleList modules;
+ *     modules.add(new fTimeModule(pipeline));
+ *     fModuleList result = pipeline.run<fModuleList>(modules,
+ *         [] (fModuleList& m, hipo::banklist& banks, long event) { m.process(banks, event);},
+ *         [] (fModuleList& m, const fModuleList& other) { m.merge(other);},
+ *         [] (fModuleList& m) { m.flush();});
+ *     result.finish("dq");
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_MODULE_H
+#define F_MODULE_H
+
+#include "reader.h"
+#include "fPipeline.h"
+#include "fH1D.h"
+#include "fProfile.h"
+#include "fWaveformBatch.h"
+#include "fKernels.h"
+#include "fHistIO.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+class fModule {
+public :
+	virtual ~fModule() {}
+	virtual std::string getName() const = 0;
+	virtual fModule* clone() const = 0; ///< copy for a thread
+	virtual void process(hipo::banklist& banks, long nEvent) = 0; ///< called for each event
+	virtual void flush() {} ///< called after the last event of each record
+	virtual void merge(const fModule& other) = 0; ///< other is a module of the same type
+	virtual void finish(std::string prefix) = 0; ///< print the results, the files are named prefix_*
+	virtual void save(fHistWriter& writer) const {} ///< add the histograms to the writer
+	virtual void summary(std::vector<std::string>& names, std::vector<double>& values) const {} ///< add a few numbers for a table of runs (see dqd.cpp)
+};
+
+class fModuleList {
+	std::vector<std::unique_ptr<fModule>> modules;
+public :
+	fModuleList() {}
+	fModuleList(const fModuleList& other); ///< clone the modules
+	fModuleList& operator=(const fModuleList& other);
+	void add(fModule* module); ///< the list owns the module
+	void add(std::string name, fPipeline& pipeline); ///< e.g "rms", see getModuleNames
+	static std::vector<std::string> getModuleNames();
+	static bool add_columns(const std::vector<std::string>& names, std::vector<fColumns>& projection); ///< columns read by the modules, false if a name is unknown
+	int size() const;
+	fModule& operator[](int i);
+	void process(hipo::banklist& banks, long nEvent);
+	void flush();
+	void merge(const fModuleList& other); ///< same modules in the same order
+	void finish(std::string prefix);
+	void save(fHistWriter& writer) const;
+	void summary(std::vector<std::string>& names, std::vector<double>& values) const;
+};
+
+/** events with a hit in the 8 layers (hits.cpp) */
+class fCosmicsModule : public fModule {
+	int bank; ///< AHDC::adc in the banklist
+	int item_layer;
+	std::vector<long> events;
+public :
+	fCosmicsModule(fPipeline& pipeline);
+	static fColumns getColumns();
+	std::string getName() const override;
+	fModule* clone() const override;
+	void process(hipo::banklist& banks, long nEvent) override;
+	void merge(const fModule& other) override;
+	void finish(std::string prefix) override;
+	void summary(std::vector<std::string>& names, std::vector<double>& values) const override;
+};
+
+/** events with many hits in the layers 42 and 51 (noise_count.cpp) */
+class fNoiseModule : public fModule {
+	int bank; ///< AHDC::wf in the banklist
+	int item_layer;
+	unsigned long int nEvent_full = 0;
+	unsigned long int nEvent_semi = 0;
+	unsigned long int nEvent_semi_semi = 0;
+	std::vector<std::vector<long>> lines; ///< event number, nhit, nhit_51, nhit_42
+public :
+	fNoiseModule(fPipeline& pipeline);
+	static fColumns getColumns();
+	std::string getName() const override;
+	fModule* clone() const override;
+	void process(hipo::banklist& banks, long nEvent) override;
+	void merge(const fModule& other) override;
+	void finish(std::string prefix) override;
+	void summary(std::vector<std::string>& names, std::vector<double>& values) const override;
+};
+
+/** RMS of the waveforms per layer and per wire (rms.cpp) */
+class fRmsModule : public fModule {
+	int bank; ///< AHDC::wf in the banklist
+	std::vector<fH1D> hist1d_rms; ///< one per layer
+	fProfile prof_rms; ///< mean RMS of each wire
+	fWaveformBatch batch; ///< waveforms of the current record
+	fWaveformStats stats;
+public :
+	fRmsModule(fPipeline& pipeline);
+	static fColumns getColumns();
+	std::string getName() const override;
+	fModule* clone() const override;
+	void process(hipo::banklist& banks, long nEvent) override;
+	void flush() override;
+	void merge(const fModule& other) override;
+	void finish(std::string prefix) override;
+	void save(fHistWriter& writer) const override;
+	void summary(std::vector<std::string>& names, std::vector<double>& values) const override;
+};
+
+/** time of the hits, all layers and per layer (first_channel.cpp) */
+class fTimeModule : public fModule {
+	int bank; ///< AHDC::adc in the banklist
+	int item_layer;
+	int item_time;
+	fH1D hist1d_time;
+	std::vector<fH1D> hist1d_time_layer; ///< one per layer
+public :
+	fTimeModule(fPipeline& pipeline);
+	static fColumns getColumns();
+	std::string getName() const override;
+	fModule* clone() const override;
+	void process(hipo::banklist& banks, long nEvent) override;
+	void merge(const fModule& other) override;
+	void finish(std::string prefix) override;
+	void save(fHistWriter& writer) const override;
+	void summary(std::vector<std::string>& names, std::vector<double>& values) const override;
+};
+
+#endif
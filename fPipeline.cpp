@@ -0,0 +1,452 @@
+/***********************************************
+ * Multi-threaded event loop
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fPipeline.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#include <sys/stat.h>
+
+static thread_local fEventIndex::Entry current_event = {-1, -1, -1}; ///< event processed by the thread
+
+static volatile sig_atomic_t stop_requested = 0; ///< Ctrl-C in follow mode
+
+/** a second Ctrl-C kills the program */
+static void request_stop(int) {
+	stop_requested = 1;
+	signal(SIGINT, SIG_DFL);
+}
+
+/** -1 if the file cannot be read */
+static long file_size(const std::string& filename) {
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0) { return -1;}
+	return info.st_size;
+}
+
+/**
+ * Number of events of each record of a HIPO file, read from
+ * the record headers only (nothing is decompressed) : the
+ * file header (14 words) is followed by the index, the user
+ * header (dictionary) and the records. Each record header
+ * gives its length in words (word 0) and its number of
+ * events (word 3).
+ *
+ * @return empty if the file does not have this layout
+ */
+static std::vector<long> count_record_events(const std::string& filename) {
+	const uint32_t hipo_magic = 0xc0da0100;
+	std::vector<long> counts;
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (file == NULL) { return counts;}
+	long size = file_size(filename);
+	uint32_t words[14];
+	if ((fread(words, sizeof(words), 1, file) != 1) || (words[7] != hipo_magic)) {
+		fclose(file);
+		return counts;
+	}
+	long padding = (words[5] >> 20) & 3; // of the user header
+	long position = 4L*words[2] + words[4] + words[6] + padding;
+	while (position + (long) sizeof(words) <= size) {
+		if ((fseek(file, position, SEEK_SET) != 0) || (fread(words, sizeof(words), 1, file) != 1)) { break;}
+		if ((words[7] != hipo_magic) || (words[0] == 0)) { break;} // not a record (e.g the trailer)
+		counts.push_back(words[3]);
+		position += 4L*words[0];
+	}
+	fclose(file);
+	return counts;
+}
+
+/** The banks and columns missing in the file are printed */
+fPipeline::fPipeline(std::string _filename, std::vector<fColumns> _projection, int _nthreads) : filename(_filename), reader(_filename.c_str()), projection(_projection), nthreads(_nthreads) {
+	hipo::dictionary dict;
+	reader.readDictionary(dict);
+	std::vector<std::string> banknames;
+	for (const fColumns& bank : projection) {
+		if (!dict.hasSchema(bank.bank.c_str())) {
+			printf("%s : no bank %s\n", filename.c_str(), bank.bank.c_str());
+			valid = false;
+		}
+		banknames.push_back(bank.bank);
+	}
+	if (valid) {
+		banklist = reader.getBanks(banknames);
+		for (int i = 0; i < (int) projection.size(); i++) {
+			for (const std::string& column : projection[i].columns) {
+				if (getColumn(i, column) < 0) {
+					printf("%s : no column %s in %s\n", filename.c_str(), column.c_str(), projection[i].bank.c_str());
+					valid = false;
+				}
+			}
+		}
+	}
+	if (nthreads < 1) {
+		nthreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+bool fPipeline::is_valid() const { return valid;}
+
+int fPipeline::getBankIndex(std::string bankname) const {
+	for (int i = 0; i < (int) projection.size(); i++) {
+		if (projection[i].bank == bankname) { return i;}
+	}
+	return -1;
+}
+
+int fPipeline::getColumn(int bank, std::string column) {
+	return banklist[bank].getSchema().getEntryOrder(column.c_str());
+}
+
+void fPipeline::add_columns(std::vector<fColumns>& projection, const fColumns& columns) {
+	for (fColumns& bank : projection) {
+		if (bank.bank == columns.bank) {
+			for (const std::string& column : columns.columns) {
+				if (std::find(bank.columns.begin(), bank.columns.end(), column) == bank.columns.end()) {
+					bank.columns.push_back(column);
+				}
+			}
+			return;
+		}
+	}
+	projection.push_back(columns);
+}
+
+std::string fPipelineOptions::getSuffix() const {
+	if (nshards <= 1) { return "";}
+	char buffer[50];
+	sprintf(buffer, "_shard%dof%d", shard, nshards);
+	return buffer;
+}
+
+std::vector<const char*> fPipeline::parse_options(int argc, char const *argv[], fPipelineOptions& options) {
+	std::vector<const char*> args;
+	for (int i = 0; i < argc; i++) {
+		bool has_value = (i + 1 < argc);
+		if ((strcmp(argv[i], "--first") == 0) && has_value) {
+			options.first = atol(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--count") == 0) && has_value) {
+			options.count = atol(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--index") == 0) && has_value) {
+			options.index = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--follow") == 0) && has_value) {
+			options.follow = atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--shard") == 0) && has_value) {
+			i++;
+			if (sscanf(argv[i], "%d/%d", &options.shard, &options.nshards) != 2) {
+				printf("--shard : %s is not of the form i/N\n", argv[i]);
+				return {};
+			}
+		}
+		else if (strncmp(argv[i], "--", 2) == 0) {
+			printf("Unknown option or missing value : %s\n", argv[i]);
+			return {};
+		}
+		else {
+			args.push_back(argv[i]);
+		}
+	}
+	if ((options.first < 0) || (options.nshards < 1) || (options.shard < 0) || (options.shard >= options.nshards)) {
+		printf("Invalid options : --first %ld --shard %d/%d\n", options.first, options.shard, options.nshards);
+		return {};
+	}
+	if ((options.follow < 0) || ((options.follow > 0) && ((options.nshards > 1) || (options.index.size() > 0)))) {
+		printf("Invalid options : --follow needs a period > 0, without --shard and --index\n");
+		return {};
+	}
+	return args;
+}
+
+const char* fPipeline::getOptionsUsage() {
+	return "   options :\n"
+		"      --first N    skip the N first events\n"
+		"      --count N    process N events (all by default)\n"
+		"      --shard i/N  process the i-th part of the N parts of the file (split by records, i from 0)\n"
+		"      --index file process only the events of an index (.fidx, written by hits, noise_count...)\n"
+		"      --follow S   the file is being written : poll it every S seconds until Ctrl-C\n";
+}
+
+bool fPipeline::set_options(const fPipelineOptions& options) {
+	set_first_event(options.first);
+	set_max_events(options.count);
+	set_shard(options.shard, options.nshards);
+	set_follow(options.follow);
+	if (options.index.size() > 0) {
+		fEventIndex _index;
+		if (!_index.read(options.index)) { return false;}
+		set_index(_index);
+		printf("Index %s : %d events (%s)\n", options.index.c_str(), index.size(), index.getTag().c_str());
+	}
+	return true;
+}
+
+void fPipeline::set_first_event(long n) { first_event = n;}
+void fPipeline::set_max_events(long n) { max_events = n;}
+/** the events of the records before the shard are counted from their headers */
+void fPipeline::set_shard(int i, int n) {
+	shard = i;
+	nshards = n;
+	shard_offset = 0;
+	long nrecords = reader.getNRecords();
+	int first_record = (nrecords*shard)/nshards;
+	if (first_record == 0) { return ;}
+	std::vector<long> counts = count_record_events(filename);
+	if ((long) counts.size() < nrecords) {
+		printf("Warning : cannot read the record headers of %s, the events are numbered from the first record of the shard\n", filename.c_str());
+		return ;
+	}
+	for (int irec = 0; irec < first_record; irec++) { shard_offset += counts[irec];}
+}
+
+void fPipeline::set_follow(double period) { follow_period = period;}
+
+void fPipeline::set_index(const fEventIndex& _index) {
+	index = _index;
+	index.sort();
+	use_index = true;
+	if ((index.getNumberOfRecords() > 0) && (index.getNumberOfRecords() != getNumberOfRecords())) {
+		printf("Warning : the index was written for a file of %d records, this one has %d records\n", index.getNumberOfRecords(), getNumberOfRecords());
+	}
+}
+
+int fPipeline::getNumberOfRecords() { return reader.getNRecords();}
+fEventIndex::Entry fPipeline::getCurrentEvent() { return current_event;}
+long fPipeline::getShardOffset() const { return shard_offset;}
+int fPipeline::getNumberOfThreads() const { return nthreads;}
+hipo::bank& fPipeline::getBank(int i) { return banklist[i];}
+
+namespace {
+	/** a decompressed record and the number of its first event in the shard */
+	struct Task {
+		std::shared_ptr<hipo::record> record;
+		int irec; ///< number of the record in the file
+		long first;
+		const fEventIndex::Entry* begin; ///< events of the index in this record, nullptr : all the events
+		const fEventIndex::Entry* end;
+	};
+
+	struct alignas(64) TaskQueue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+}
+
+/**
+ * At most 2 records per thread wait in the queues, the
+ * reader stage sleeps when they are full.
+ */
+void fPipeline::execute(const std::function<void(int, hipo::banklist&, long)>& process, const std::function<void(int)>& end_of_record, const std::function<void()>& snapshot) {
+	std::vector<TaskQueue> queues(nthreads);
+	std::mutex mutex; // protects available, completed and finished
+	std::condition_variable cv_work; // a task is available or the file is finished
+	std::condition_variable cv_space; // a task has been taken
+	std::condition_variable cv_done; // a task has been processed
+	int available = 0; // tasks in the queues not yet reserved by a worker
+	int completed = 0; // tasks processed
+	bool finished = false;
+	const int max_available = 2*nthreads;
+
+	// wait for a task, take it from the queue of the thread or steal it
+	auto take = [&] (int thread, Task& task) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_work.wait(lock, [&] { return (available > 0) || finished;});
+			if (available == 0) { return false;}
+			available--; // a task is reserved, it is in one of the queues
+		}
+		cv_space.notify_one();
+		while (true) {
+			for (int k = 0; k < nthreads; k++) {
+				TaskQueue& queue = queues[(thread + k) % nthreads];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (queue.tasks.empty()) { continue;}
+				if (k == 0) { // own queue : oldest record first
+					task = queue.tasks.front();
+					queue.tasks.pop_front();
+				}
+				else { // steal the newest record
+					task = queue.tasks.back();
+					queue.tasks.pop_back();
+				}
+				return true;
+			}
+		}
+	};
+
+	const long last_event = (max_events >= 0) ? first_event + max_events : -1; // -1 : no limit
+	long nrecords = reader.getNRecords();
+	int first_record = (nrecords*shard)/nshards;
+	int last_record = (nrecords*(shard + 1))/nshards;
+	const long offset = use_index ? 0 : shard_offset;
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < nthreads; thread++) {
+		workers.emplace_back([&, thread] () {
+			hipo::banklist banks = banklist;
+			hipo::event event;
+			Task task;
+			// number : in the file
+			auto read = [&] (int i, long number) {
+				task.record->readHipoEvent(event, i);
+				for (hipo::bank& bank : banks) {
+					event.getStructure(bank);
+				}
+				current_event = fEventIndex::Entry{task.irec, i, number};
+				process(thread, banks, number);
+			};
+			while (take(thread, task)) {
+				int nevents = task.record->getEventCount();
+				if (task.begin == nullptr) {
+					for (int i = 0; i < nevents; i++) {
+						long number = task.first + i;
+						if (number < first_event) { continue;}
+						if ((last_event >= 0) && (number >= last_event)) { break;}
+						read(i, offset + number);
+					}
+				}
+				else { // events of the index, --first and --count are applied by the reader stage
+					for (const fEventIndex::Entry* entry = task.begin; entry < task.end; entry++) {
+						if (entry->index >= nevents) { continue;}
+						read(entry->index, entry->number);
+					}
+				}
+				if (end_of_record) { end_of_record(thread);}
+				task.record.reset();
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					completed++;
+				}
+				cv_done.notify_one();
+			}
+		});
+	}
+
+	// reader stage : the records of the shard
+	int ntasks = 0;
+	auto push = [&] (const Task& task) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_space.wait(lock, [&] { return available < max_available;});
+		}
+		{
+			TaskQueue& queue = queues[(ntasks++) % nthreads];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(task);
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			available++;
+		}
+		cv_work.notify_one();
+	};
+	if (!use_index) {
+		long first = 0; // number of the first event of the record, in the shard
+		int irec = first_record; // next record to read
+		// the records before --first are skipped with the counts of their headers (not decompressed)
+		std::vector<long> counts;
+		if (first_event > 0) {
+			counts = count_record_events(filename);
+			if ((long) counts.size() < nrecords) { counts.clear();} // they are then loaded to count their events
+		}
+		// push the records [irec, end[ of source, false when all the events wanted are read
+		auto push_records = [&] (hipo::reader& source, int end) {
+			for (; irec < end; irec++) {
+				if ((last_event >= 0) && (first >= last_event)) { return false;}
+				if ((irec < (int) counts.size()) && (first + counts[irec] <= first_event)) {
+					first += counts[irec];
+					continue;
+				}
+				auto record = std::make_shared<hipo::record>();
+				if (!source.loadRecord(*record, irec)) { break;} // incomplete, read again at the next poll
+				int nevents = record->getEventCount();
+				if (first + nevents > first_event) { // else all the events are before the first one
+					push(Task{record, irec, first, nullptr, nullptr});
+				}
+				first += nevents;
+			}
+			return (last_event < 0) || (first < last_event);
+		};
+		if (follow_period <= 0) {
+			push_records(reader, last_record);
+		}
+		else {
+			// the last record is being written
+			bool more = push_records(reader, last_record - 1);
+			stop_requested = 0;
+			auto previous = signal(SIGINT, request_stop);
+			long size = file_size(filename);
+			int idle = 0; // polls without new data
+			int snapshot_records = -1; // records read at the last snapshot
+			while (more && !stop_requested && (idle < follow_idle_polls)) {
+				if (irec != snapshot_records) {
+					{ // the workers wait : the states can be read
+						std::unique_lock<std::mutex> lock(mutex);
+						cv_done.wait(lock, [&] { return completed == ntasks;});
+					}
+					printf("Follow %s : %d records, %ld events\n", filename.c_str(), irec, first);
+					if (snapshot) { snapshot();}
+					snapshot_records = irec;
+				}
+				auto wake_up = std::chrono::steady_clock::now() + std::chrono::duration<double>(follow_period);
+				while (!stop_requested && (std::chrono::steady_clock::now() < wake_up)) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				}
+				long new_size = file_size(filename);
+				if (new_size == size) {
+					idle++;
+					continue;
+				}
+				idle = 0;
+				size = new_size;
+				hipo::reader source(filename.c_str()); // reopened to find the new records
+				more = push_records(source, source.getNRecords() - 1);
+			}
+			if (more && !stop_requested) { // the file is complete
+				hipo::reader source(filename.c_str());
+				push_records(source, source.getNRecords());
+			}
+			signal(SIGINT, previous);
+		}
+	}
+	else { // only the records with events of the index
+		// entries of the shard (sorted by record), then --first and --count as positions in them
+		const std::vector<fEventIndex::Entry>& all = index.getEntries();
+		auto record_less = [] (const fEventIndex::Entry& entry, int irec) { return entry.record < irec;};
+		const fEventIndex::Entry* entries = all.data() + (std::lower_bound(all.begin(), all.end(), first_record, record_less) - all.begin());
+		const fEventIndex::Entry* last = all.data() + (std::lower_bound(all.begin(), all.end(), last_record, record_less) - all.begin());
+		entries += std::min<long>(first_event, last - entries);
+		if (max_events >= 0) { last = entries + std::min<long>(max_events, last - entries);}
+		for (const fEventIndex::Entry* begin = entries; begin < last; ) {
+			int irec = begin->record;
+			const fEventIndex::Entry* end = begin;
+			while ((end < last) && (end->record == irec)) { end++;}
+			auto record = std::make_shared<hipo::record>();
+			reader.loadRecord(*record, irec);
+			push(Task{record, irec, 0, begin, end});
+			begin = end;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	cv_work.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
@@ -0,0 +1,198 @@
+/***********************************************
+ * Multi-threaded event loop
+ *
+ * Replaces the single-threaded
+ *     while (reader.next(banklist)) {...}
+ * of the analysis executables :
+ *   - the reader stage (calling thread) loads and
+ *     decompresses the HIPO records one after the
+ *     other,
+ *   - a pool of worker threads reads the events of
+ *     the records and runs the analysis callback,
+ *     one record at a time. Each worker has its own
+ *     queue of records and steals from the others
+ *     when it is empty,
+ *   - each worker fills its own copy of the
+ *     analysis state, the copies are merged in the
+ *     thread order at the end.
+ *
+ * The events of a record form a batch : an
+ * optional callback is run at the end of each
+ * record (e.g to process a fWaveformBatch).
+ *
+ * The program declares the banks and the columns
+ * it reads (fColumns) : only these banks are read
+ * from the events, the columns are checked when
+ * the file is opened and their numbers are
+ * resolved once (getColumn), the values are then
+ * read by number (no search by name per row).
+ *
+ * e.g
+ *     fPipeline pipeline(filename, {{"AHDC::adc", {"time"}}});
+ *     const int item_time = pipeline.getColumn(0, "time");
+ *     fH1D result = pipeline.run<fH1D>(model,
+ *         [] (fH1D& h, hipo::banklist& banks, long event) {...},
+ *         [] (fH1D& h, const fH1D& other) { h.merge(other);});
+ *
+ * The events to process are selected with
+ * fPipelineOptions (--first, --count, --shard) :
+ * a shard i/N only reads the records
+ * [i*nrecords/N, (i+1)*nrecords/N[ of the file, the
+ * other records are neither read nor decompressed.
+ * The event numbers given to the callback are the
+ * numbers in the file : the events of the records
+ * skipped are counted from the record headers only
+ * (if they cannot be read, a warning is printed and
+ * the numbers count from the first record of the
+ * shard). --first and --count count the events of
+ * the shard, the records before --first are also
+ * skipped with the counts of their headers.
+ *
+ * With an index of events (--index, see
+ * fEventIndex), only the records of the index
+ * are read and only its events are processed,
+ * with the numbers stored in the index. The
+ * position of the event being processed is given
+ * by getCurrentEvent() (e.g to write an index).
+ * --first and --count are then positions in the
+ * index (of the events of the shard) : --first N
+ * skips its N first events, --count N processes
+ * the N next ones, the records after are not read.
+ *
+ * In follow mode (--follow S), the file is still
+ * being written (e.g by the DAQ) : after the
+ * records already in the file, its size is
+ * checked every S seconds and the records added
+ * are processed when it grows. The last record of
+ * the file may be incomplete, it is processed when
+ * the file stops growing. The states are kept
+ * between two polls, an optional callback receives
+ * the merged state after each poll (e.g to write a
+ * snapshot of the histograms). It stops after
+ * Ctrl-C (without the last record), or when the
+ * file has not grown for follow_idle_polls polls.
+ *
+ * @note the callback runs in parallel, it must
+ * only modify its state (no ROOT objects, no
+ * shared counters)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_PIPELINE_H
+#define F_PIPELINE_H
+
+#include "reader.h"
+#include "fEventIndex.h"
+#include <string>
+#include <vector>
+#include <functional>
+
+/** a bank and the columns read by a program */
+struct fColumns {
+	std::string bank;
+	std::vector<std::string> columns; ///< empty : no column checked
+};
+
+/** selection of the events, common to all the executables */
+struct fPipelineOptions {
+	long first = 0; ///< first event processed (in the shard, or position in the index)
+	long count = -1; ///< number of events processed (-1 : all), also with an index
+	int shard = 0; ///< part of the file processed, in [0, nshards[
+	int nshards = 1;
+	std::string index; ///< file of an index of events to process, see fEventIndex
+	double follow = 0; ///< period of the polls of a file being written, in seconds (0 : no follow mode)
+	std::string getSuffix() const; ///< "" or "_shard<i>of<N>", to name the partial outputs
+};
+
+class fPipeline {
+public :
+	static const int follow_idle_polls = 10; ///< the follow mode stops after this number of polls without new data
+private :
+	std::string filename;
+	hipo::reader reader;
+	hipo::banklist banklist; ///< model of the banks read in each event
+	std::vector<fColumns> projection; ///< banks and columns used by the program
+	bool valid = true; ///< all the banks and columns of the projection exist
+	int nthreads; ///< number of worker threads
+	long first_event = 0; ///< skip the events before
+	long max_events = -1; ///< process only max_events events (-1 : all)
+	int shard = 0; ///< process only the records of the shard
+	int nshards = 1;
+	long shard_offset = 0; ///< number in the file of the first event of the shard
+	bool use_index = false; ///< process only the events of the index
+	fEventIndex index;
+	double follow_period = 0; ///< seconds, 0 : the file is complete
+	/**
+	 * process(thread, banks, event) for all the events, in follow mode
+	 * snapshot() is called after each poll, while the workers wait
+	 */
+	void execute(const std::function<void(int, hipo::banklist&, long)>& process, const std::function<void(int)>& end_of_record, const std::function<void()>& snapshot);
+public :
+	fPipeline(std::string filename, std::vector<fColumns> _projection, int _nthreads = 0); ///< 0 : one thread per core
+	bool is_valid() const;
+	int getBankIndex(std::string bankname) const; ///< position in the banklist given to the callback, -1 if not read
+	int getColumn(int bank, std::string column); ///< column number, for hipo::bank::getInt(int, int)..., -1 if not found
+	static void add_columns(std::vector<fColumns>& projection, const fColumns& columns); ///< union of the columns of the same bank
+	/**
+	 * remove --first N, --count N, --shard i/N and --index file from the
+	 * arguments of the program
+	 *
+	 * @return the other arguments (argv[0] first), empty if
+	 * an option is not valid
+	 */
+	static std::vector<const char*> parse_options(int argc, char const *argv[], fPipelineOptions& options);
+	static const char* getOptionsUsage(); ///< to be printed with the usage of a program
+	bool set_options(const fPipelineOptions& options); ///< false if the index cannot be read
+	void set_first_event(long n);
+	void set_max_events(long n);
+	void set_shard(int i, int n); ///< i-th part of n
+	void set_index(const fEventIndex& _index);
+	void set_follow(double period); ///< seconds between two polls of the file, 0 : no follow mode
+	int getNumberOfRecords();
+	static fEventIndex::Entry getCurrentEvent(); ///< record, position and number of the event processed by the calling thread
+	long getShardOffset() const; ///< number in the file of the first event of the shard (without index)
+	int getNumberOfThreads() const;
+	hipo::bank& getBank(int i); ///< model of the i-th bank (e.g to resolve its columns)
+
+	/**
+	 * @param model initial state, copied for each thread
+	 * @param process called for each event with the state of the thread
+	 * @param reduce merge the second state in the first one
+	 * @param flush (optional) called after the last event of each record,
+	 * e.g to process the events accumulated in the state as a batch
+	 * @param snapshot (optional) follow mode : called after each poll of
+	 * the file with the states merged so far
+	 * @return the merged state
+	 */
+	template <typename State>
+	State run(const State& model, std::function<void(State&, hipo::banklist&, long)> process, std::function<void(State&, const State&)> reduce, std::function<void(State&)> flush = nullptr, std::function<void(const State&)> snapshot = nullptr) {
+		struct alignas(64) Slot { State state; }; ///< one cache line at least between two states
+		std::vector<Slot> slots(nthreads, Slot{model});
+		std::function<void(int)> end_of_record = nullptr;
+		if (flush) {
+			end_of_record = [&slots, &flush] (int thread) { flush(slots[thread].state);};
+		}
+		std::function<void()> merged_snapshot = nullptr;
+		if (snapshot) {
+			merged_snapshot = [&] () {
+				State merged = slots[0].state;
+				for (int i = 1; i < nthreads; i++) {
+					reduce(merged, slots[i].state);
+				}
+				snapshot(merged);
+			};
+		}
+		execute([&slots, &process] (int thread, hipo::banklist& banks, long event) {
+			process(slots[thread].state, banks, event);
+		}, end_of_record, merged_snapshot);
+		State result = slots[0].state;
+		for (int i = 1; i < nthreads; i++) {
+			reduce(result, slots[i].state);
+		}
+		return result;
+	}
+};
+
+#endif
@@ -0,0 +1,274 @@
+/***********************************************
+ * Profile : mean and spread of y in bins of x
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fProfile.h"
+#include "fCanvas.h"
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+fProfile::fProfile(std::string _title, int _nbins, double _xmin, double _xmax) : title(_title), nbins(_nbins), xmin(_xmin), xmax(_xmax) {
+	if (nbins < 1) {
+		printf("fProfile %s : the number of bins must be > 0\n", title.c_str());
+		nbins = 1;
+	}
+	binw = (xmax - xmin)/nbins;
+	inv_binw = nbins/(xmax - xmin);
+	reset();
+}
+
+/**
+ * @note numerotation starts at 0
+ * @note return -1 if underflow (or nan) and -11 if overflow
+ */
+int fProfile::getBinNumber(double x) const {
+	if (!(x >= xmin)) {return -1;}
+	if (x >= xmax) {return -11;}
+	int bin = (x - xmin)*inv_binw;
+	return (bin < nbins) ? bin : nbins - 1;
+}
+
+/**
+ * Weighted Welford step (D. H. D. West, 1979)
+ */
+void fProfile::update(int bin, double y, double w) {
+	double sw = sumw[bin] + w;
+	double delta = y - mean[bin];
+	double r = (sw != 0) ? w/sw : 0;
+	mean[bin] += delta*r;
+	m2[bin] += w*delta*(y - mean[bin]);
+	sumw[bin] = sw;
+	sumw2[bin] += w*w;
+	entries[bin]++;
+}
+
+void fProfile::fill(double x, double y) { fill(x, y, 1.0);}
+
+void fProfile::fill(double x, double y, double w) {
+	int bin = getBinNumber(x);
+	if (bin == -1) { underflow++; return ;}
+	if (bin == -11) { overflow++; return ;}
+	update(bin, y, w);
+}
+
+/**
+ * fill n points (x[i], y[i]) with weights w[i]
+ *
+ * The bin numbers of a chunk are computed first
+ * (vectorized loop), the accumulators are then
+ * updated in the order of the points.
+ *
+ * @note w == nullptr means a weight of 1 for all points
+ */
+void fProfile::fill_batch(const double* x, const double* y, int n, const double* w) {
+	const int chunk = 256;
+	int bins[chunk];
+	for (int start = 0; start < n; start += chunk) {
+		int m = std::min(chunk, n - start);
+		const double* xc = x + start;
+		// bin numbers : -1 for underflow (or nan), nbins for overflow
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			double t = (xc[i] - xmin)*inv_binw;
+			t = (t > 0) ? t : 0;
+			t = (t < nbins - 1) ? t : nbins - 1;
+			int bin = t;
+			bin = (xc[i] < xmax) ? bin : nbins;
+			bin = (xc[i] >= xmin) ? bin : -1;
+			bins[i] = bin;
+		}
+		for (int i = 0; i < m; i++) {
+			int bin = bins[i];
+			if (bin < 0) { underflow++; continue;}
+			if (bin == nbins) { overflow++; continue;}
+			update(bin, y[start + i], (w == nullptr) ? 1.0 : w[start + i]);
+		}
+	}
+}
+
+void fProfile::fill_bins(const int* bins, const double* y, int n) {
+	for (int i = 0; i < n; i++) {
+		if (bins[i] < 0) { underflow++; continue;}
+		if (bins[i] >= nbins) { overflow++; continue;}
+		update(bins[i], y[i], 1.0);
+	}
+}
+
+int fProfile::getNumberOfBins() const { return nbins;}
+double fProfile::getBinCenter(int bin) const { return xmin + (bin + 0.5)*binw;}
+
+unsigned long int fProfile::getBinEntries(int bin) const {
+	if ((bin < 0) || (bin >= nbins)) { return 0;}
+	return entries[bin];
+}
+
+double fProfile::getBinSumOfWeights(int bin) const {
+	if ((bin < 0) || (bin >= nbins)) { return 0;}
+	return sumw[bin];
+}
+
+double fProfile::getBinSumOfSquaredWeights(int bin) const {
+	if ((bin < 0) || (bin >= nbins)) { return 0;}
+	return sumw2[bin];
+}
+
+double fProfile::getBinM2(int bin) const {
+	if ((bin < 0) || (bin >= nbins)) { return 0;}
+	return m2[bin];
+}
+
+double fProfile::getBinMean(int bin) const {
+	if ((bin < 0) || (bin >= nbins) || (sumw[bin] == 0)) { return 0;}
+	return mean[bin];
+}
+
+double fProfile::getBinStDev(int bin) const {
+	if ((bin < 0) || (bin >= nbins) || !(sumw[bin] > 0)) { return 0;}
+	return sqrt(std::max(m2[bin]/sumw[bin], 0.0));
+}
+
+double fProfile::getBinError(int bin) const {
+	double stdev = getBinStDev(bin);
+	if ((error_mode == PROFILE_ERROR_SPREAD) || (stdev == 0)) { return stdev;}
+	double neff = sumw[bin]*sumw[bin]/sumw2[bin]; // effective number of entries
+	return stdev/sqrt(neff);
+}
+
+unsigned long int fProfile::getEntries() const {
+	unsigned long int n = 0;
+	for (int bin = 0; bin < nbins; bin++) { n += entries[bin];}
+	return n;
+}
+
+unsigned long int fProfile::getUnderflow() const { return underflow;}
+unsigned long int fProfile::getOverflow() const { return overflow;}
+double fProfile::getXmin() const { return xmin;}
+double fProfile::getXmax() const { return xmax;}
+std::string fProfile::getTitle() const { return title;}
+std::string fProfile::getXtitle() const { return xtitle;}
+std::string fProfile::getYtitle() const { return ytitle;}
+
+fH1D fProfile::projection() const {
+	fH1D h(title, nbins, xmin, xmax);
+	h.set_xtitle(xtitle);
+	h.set_ytitle(ytitle);
+	for (int bin = 0; bin < nbins; bin++) {
+		h.set_bin_content(bin, getBinMean(bin));
+	}
+	return h;
+}
+
+/**
+ * Combine the accumulators bin by bin (Chan et al.),
+ * e.g for per-thread profiles. The result does not
+ * depend on how the points were split.
+ *
+ * @return false if the binnings are different
+ */
+bool fProfile::merge(const fProfile& other) {
+	if ((nbins != other.nbins) || (xmin != other.xmin) || (xmax != other.xmax)) {
+		printf("Cannot merge %s with %s : different binnings\n", title.c_str(), other.title.c_str());
+		return false;
+	}
+	#pragma omp simd
+	for (int bin = 0; bin < nbins; bin++) {
+		double wa = sumw[bin];
+		double wb = other.sumw[bin];
+		double sw = wa + wb;
+		double delta = other.mean[bin] - mean[bin];
+		double r = (sw != 0) ? wb/sw : 0;
+		mean[bin] += delta*r;
+		m2[bin] += other.m2[bin] + delta*delta*wa*r;
+		sumw[bin] = sw;
+		sumw2[bin] += other.sumw2[bin];
+		entries[bin] += other.entries[bin];
+	}
+	underflow += other.underflow;
+	overflow += other.overflow;
+	return true;
+}
+
+void fProfile::set_error_mode(fProfileError mode) { error_mode = mode;}
+void fProfile::set_xtitle(std::string name) { xtitle = name;}
+void fProfile::set_ytitle(std::string name) { ytitle = name;}
+void fProfile::set_color(fColor _color) { color = _color;}
+
+void fProfile::set_bin(int bin, unsigned long int _entries, double _sumw, double _sumw2, double _mean, double _m2) {
+	if ((bin < 0) || (bin >= nbins)) { return ;}
+	entries[bin] = _entries;
+	sumw[bin] = _sumw;
+	sumw2[bin] = _sumw2;
+	mean[bin] = _mean;
+	m2[bin] = _m2;
+}
+
+void fProfile::set_outside(unsigned long int _underflow, unsigned long int _overflow) {
+	underflow = _underflow;
+	overflow = _overflow;
+}
+
+void fProfile::reset() {
+	entries.assign(nbins, 0);
+	sumw.assign(nbins, 0.0);
+	sumw2.assign(nbins, 0.0);
+	mean.assign(nbins, 0.0);
+	m2.assign(nbins, 0.0);
+	underflow = 0;
+	overflow = 0;
+}
+
+void fProfile::print() const {
+	printf("Title : %s , nEntries : %ld , underflow : %ld , overflow : %ld\n", title.c_str(), getEntries(), underflow, overflow);
+	for (int bin = 0; bin < nbins; bin++) {
+		if (entries[bin] == 0) { continue;}
+		printf("%10.2lf : %6ld entries , mean : %lf +/- %lf , stdev : %lf\n", getBinCenter(bin), entries[bin], getBinMean(bin), getBinError(bin), getBinStDev(bin));
+	}
+}
+
+/**
+ * One marker per non empty bin, with vertical error
+ * bars (see set_error_mode)
+ */
+void fProfile::draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height) const {
+	// y range : all the error bars
+	double ymin = 0, ymax = 0;
+	bool first = true;
+	for (int bin = 0; bin < nbins; bin++) {
+		if (entries[bin] == 0) { continue;}
+		double err = getBinError(bin);
+		ymin = first ? mean[bin] - err : std::min(ymin, mean[bin] - err);
+		ymax = first ? mean[bin] + err : std::max(ymax, mean[bin] + err);
+		first = false;
+	}
+	if (ymax <= ymin) { // empty or flat
+		ymin -= 1;
+		ymax += 1;
+	}
+	fCanvas canvas(width, height, xmin, xmax, ymin, ymax);
+	canvas.define_coord_system(cr);
+	canvas.draw_title(cr, title);
+	canvas.draw_xtitle(cr, xtitle);
+	canvas.draw_ytitle(cr, ytitle);
+	cr->set_source_rgb(color.r, color.g, color.b);
+	cr->set_line_width(0.003*canvas.get_seff());
+	// markers smaller than the bins when there are many bins (e.g one per wire)
+	double marker_size = std::max(1.0, std::min(4.0, 0.3*canvas.get_weff()/nbins));
+	for (int bin = 0; bin < nbins; bin++) {
+		if (entries[bin] == 0) { continue;}
+		double err = getBinError(bin);
+		int w = canvas.x2w(getBinCenter(bin));
+		int h = canvas.y2h(mean[bin]);
+		cr->move_to(w, canvas.y2h(mean[bin] - err));
+		cr->line_to(w, canvas.y2h(mean[bin] + err));
+		cr->stroke();
+		cr->move_to(w + marker_size, h);
+		cr->arc(w, h, marker_size, 0, 2*M_PI);
+		cr->fill();
+	}
+	canvas.set_frame_line_width(0.005);
+	canvas.draw_frame(cr);
+}
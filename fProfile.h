@@ -0,0 +1,94 @@
+/***********************************************
+ * Profile : mean and spread of y in bins of x
+ *
+ * e.g mean RMS per wire, mean ADC vs HV
+ *
+ * Each bin keeps a running (Welford) mean and
+ * sum of squared deviations, numerically stable
+ * even for large offsets (pedestals). The
+ * accumulators are stored per quantity (one
+ * array for the weights, one for the means...)
+ * so that the batch and merge loops run over
+ * contiguous memory.
+ *
+ * B. P. Welford, Technometrics 4 (1962) 419
+ * T. F. Chan, G. H. Golub, R. J. LeVeque,
+ * "Updating formulae and a pairwise algorithm
+ * for computing sample variances" (1979)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_PROFILE_H
+#define F_PROFILE_H
+
+#include "fH1D.h"
+#include <gtkmm.h>
+#include <string>
+#include <vector>
+
+/** What the error bars of a fProfile represent */
+enum fProfileError {
+	PROFILE_ERROR_MEAN, ///< error on the mean : stdev/sqrt(neff)
+	PROFILE_ERROR_SPREAD ///< spread of the values : stdev
+};
+
+class fProfile {
+private :
+	std::string title;
+	std::string xtitle;
+	std::string ytitle;
+	int nbins; ///< number of bins
+	double xmin; ///< lower edge of the first bin
+	double xmax; ///< upper edge of the last bin
+	double binw; ///< bin width
+	double inv_binw; ///< 1/binw
+	std::vector<unsigned long int> entries; ///< number of entries per bin
+	std::vector<double> sumw; ///< sum of weights per bin
+	std::vector<double> sumw2; ///< sum of squared weights per bin
+	std::vector<double> mean; ///< weighted mean of y per bin
+	std::vector<double> m2; ///< sum of w*(y - mean)^2 per bin
+	unsigned long int underflow; ///< number of entries below xmin
+	unsigned long int overflow; ///< number of entries above xmax
+	fProfileError error_mode = PROFILE_ERROR_MEAN;
+	fColor color = {0.0, 0.0, 1.0};
+	void update(int bin, double y, double w); ///< Welford step
+public :
+	fProfile(std::string _title, int _nbins, double _xmin, double _xmax);
+	void fill(double x, double y);
+	void fill(double x, double y, double w);
+	void fill_batch(const double* x, const double* y, int n, const double* w = nullptr);
+	void fill_bins(const int* bins, const double* y, int n); ///< bin numbers known (e.g channel numbers), out of range bins are ignored
+	int getBinNumber(double x) const; ///< same convention as fH1D
+	int getNumberOfBins() const;
+	double getBinCenter(int bin) const;
+	unsigned long int getBinEntries(int bin) const;
+	double getBinSumOfWeights(int bin) const;
+	double getBinSumOfSquaredWeights(int bin) const;
+	double getBinMean(int bin) const; ///< 0 if the bin is empty
+	double getBinM2(int bin) const; ///< sum of w*(y - mean)^2 in the bin
+	double getBinStDev(int bin) const; ///< spread of y in the bin
+	double getBinError(int bin) const; ///< according to the error mode
+	unsigned long int getEntries() const;
+	unsigned long int getUnderflow() const;
+	unsigned long int getOverflow() const;
+	double getXmin() const;
+	double getXmax() const;
+	std::string getTitle() const;
+	std::string getXtitle() const;
+	std::string getYtitle() const;
+	fH1D projection() const; ///< fH1D of the bin means
+	bool merge(const fProfile& other);
+	void set_error_mode(fProfileError mode);
+	void set_xtitle(std::string name);
+	void set_ytitle(std::string name);
+	void set_color(fColor _color);
+	void set_bin(int bin, unsigned long int _entries, double _sumw, double _sumw2, double _mean, double _m2); ///< accumulators of a bin (e.g read from a file)
+	void set_outside(unsigned long int _underflow, unsigned long int _overflow);
+	void reset();
+	void print() const;
+	void draw_with_cairo(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height) const;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/***********************************************
+ * Pulse features of batches of waveforms
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fPulse.h"
+#include <algorithm>
+#include <cmath>
+
+static const int nsamples = fWaveformBatch::nsamples;
+
+// as in fShape.cpp : the blocks are also compiled for AVX2
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__linux__)
+#define F_PULSE_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define F_PULSE_CLONES
+#endif
+
+void fPulseResults::resize(int nhits) {
+	adc.resize(nhits);
+	integral.resize(nhits);
+	adc_offset.resize(nhits);
+	time.resize(nhits);
+	leading_edge.resize(nhits);
+	trailing_edge.resize(nhits);
+	tot.resize(nhits);
+	cfd_time.resize(nhits);
+}
+
+double fPulseResults::getFeature(int feature, int hit) const {
+	switch (feature) {
+		case PULSE_ADC : return adc[hit];
+		case PULSE_INTEGRAL : return integral[hit];
+		case PULSE_OFFSET : return adc_offset[hit];
+		case PULSE_TIME : return time[hit];
+		case PULSE_LEADING_EDGE : return leading_edge[hit];
+		case PULSE_TOT : return tot[hit];
+		case PULSE_CFD : return cfd_time[hit];
+		default : return 0;
+	}
+}
+
+const char* fPulseResults::getFeatureName(int feature) {
+	switch (feature) {
+		case PULSE_ADC : return "ADC";
+		case PULSE_INTEGRAL : return "integral";
+		case PULSE_OFFSET : return "adcOffset";
+		case PULSE_TIME : return "time";
+		case PULSE_LEADING_EDGE : return "leadingEdgeTime";
+		case PULSE_TOT : return "timeOverThreshold";
+		case PULSE_CFD : return "constantFractionTime";
+		default : return "";
+	}
+}
+
+fPulse::fPulse() : fraction(0.5), cfd_fraction(0.3), cfd_delay(5), npedestal(1), sampling_time(50), time_mode(PULSE_TIME_BIN) {}
+
+void fPulse::set_fraction(double f) { fraction = f;}
+void fPulse::set_cfd(double f, int delay) { cfd_fraction = f; cfd_delay = std::min(std::max(delay, 1), nsamples - 1);}
+void fPulse::set_npedestal(int n) { npedestal = std::min(std::max(n, 1), nsamples);}
+void fPulse::set_sampling_time(double t) { sampling_time = t;}
+void fPulse::set_time_mode(fPulseTimeMode mode) { time_mode = mode;}
+
+/**
+ * Hits [h0, h0 + m[ : three passes over the samples (peak
+ * and integral, threshold crossings, zero of the CFD), each
+ * one is a vectorized loop over the hits of the block
+ */
+F_PULSE_CLONES
+static void extract_block(const int16_t* samples, int stride, int h0, int m, const int16_t* lengths, const float* pedestals,
+		float fraction, float cfd_fraction, int cfd_delay, int npedestal, fPulseResults& results) {
+	const int block = 64;
+	float ped[block], peak[block], sum[block];
+	int len[block], bpk[block], rise[block], fall[block], zero[block];
+	for (int i = 0; i < m; i++) {
+		len[i] = lengths[h0 + i];
+		ped[i] = 0;
+		sum[i] = 0;
+		peak[i] = -1; // the first sample is a candidate
+		bpk[i] = 0;
+	}
+	// pedestal : the given one or the mean of the first valid samples
+	if (pedestals != nullptr) {
+		for (int i = 0; i < m; i++) { ped[i] = pedestals[h0 + i];}
+	}
+	else {
+		for (int s = 0; s < npedestal; s++) {
+			const int16_t* x = samples + s*stride + h0;
+			#pragma omp simd
+			for (int i = 0; i < m; i++) {
+				ped[i] += (s < len[i]) ? x[i] : 0;
+			}
+		}
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			int n = (len[i] < npedestal) ? len[i] : npedestal;
+			ped[i] = ped[i]/n;
+		}
+	}
+	// pass 1 : peak and integral of the corrected samples
+	for (int s = 0; s < nsamples; s++) {
+		const int16_t* x = samples + s*stride + h0;
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			float c = x[i] - ped[i];
+			c = (c > 0) ? c : 0; // no std::max, it prevents the vectorization
+			float pk = peak[i];
+			bpk[i] = (c > pk) ? s : bpk[i];
+			peak[i] = (c > pk) ? c : pk;
+			sum[i] += (s < len[i]) ? c : 0;
+		}
+	}
+	// pass 2 : last pass below the threshold before the peak, first pass below after
+	for (int i = 0; i < m; i++) {
+		rise[i] = 0;
+		fall[i] = nsamples; // not found
+	}
+	for (int s = 0; s < nsamples; s++) {
+		const int16_t* x = samples + s*stride + h0;
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			float c = x[i] - ped[i];
+			c = (c > 0) ? c : 0;
+			float threshold = fraction*peak[i];
+			int before = (s < bpk[i]);
+			rise[i] = (before & (c < threshold)) ? s : rise[i];
+			int candidate = s + nsamples*(before | (c > threshold));
+			fall[i] = (candidate < fall[i]) ? candidate : fall[i];
+		}
+	}
+	// pass 3 : first s after the leading edge with cfd[s-1] > 0 and cfd[s] <= 0
+	for (int i = 0; i < m; i++) {
+		zero[i] = nsamples; // not found
+	}
+	for (int s = cfd_delay + 1; s < nsamples; s++) {
+		const int16_t* x = samples + s*stride + h0;
+		const int16_t* xp = x - stride;
+		const int16_t* xd = x - cfd_delay*stride;
+		const int16_t* xpd = xp - cfd_delay*stride;
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			float c = x[i] - ped[i], cp = xp[i] - ped[i], cd = xd[i] - ped[i], cpd = xpd[i] - ped[i];
+			c = (c > 0) ? c : 0;
+			cp = (cp > 0) ? cp : 0;
+			cd = (cd > 0) ? cd : 0;
+			cpd = (cpd > 0) ? cpd : 0;
+			float cfd = cfd_fraction*c - cd;
+			float cfdp = cfd_fraction*cp - cpd;
+			int crossing = (s - 1 >= rise[i]) & (cfdp > 0) & (cfd <= 0);
+			int candidate = s + nsamples*(1 - crossing);
+			zero[i] = (candidate < zero[i]) ? candidate : zero[i];
+		}
+	}
+	for (int i = 0; i < m; i++) {
+		int h = h0 + i;
+		results.adc[h] = lrintf(peak[i]);
+		results.integral[h] = sum[i];
+		results.adc_offset[h] = ped[i];
+		results.time[h] = bpk[i]; // bins, see extract
+		results.leading_edge[h] = rise[i];
+		results.trailing_edge[h] = fall[i];
+		results.cfd_time[h] = zero[i];
+	}
+}
+
+void fPulse::extract(const int16_t* samples, int stride, int nhits, const int16_t* lengths, fPulseResults& results, const float* pedestals) const {
+	if ((int) results.adc.size() < nhits) { results.resize(nhits);}
+	const int block = 64;
+	for (int h0 = 0; h0 < nhits; h0 += block) {
+		extract_block(samples, stride, h0, std::min(block, nhits - h0), lengths, pedestals, fraction, cfd_fraction, cfd_delay, npedestal, results);
+	}
+	// fits, a few samples per hit
+	for (int h = 0; h < nhits; h++) {
+		float ped = results.adc_offset[h];
+		auto corr = [&] (int bin) { float c = samples[bin*stride + h] - ped; return (c > 0) ? c : 0.0f;};
+		int binPeak = results.time[h];
+		float adc_peak = corr(binPeak);
+		float threshold = fraction*adc_peak;
+		// time of the peak
+		float time = binPeak;
+		if ((time_mode == PULSE_TIME_PARABOLA) && (binPeak > 0) && (binPeak < nsamples - 1)) {
+			float y0 = corr(binPeak - 1), y2 = corr(binPeak + 1);
+			float curvature = y0 - 2*adc_peak + y2;
+			time = (curvature == 0) ? binPeak : binPeak + 0.5f*(y0 - y2)/curvature;
+		}
+		// leading and trailing edges, as in is_recognized
+		int binRise = results.leading_edge[h];
+		float slopeRise = corr(binRise+1) - corr(binRise);
+		float fittedBinRise = (slopeRise == 0) ? binRise : binRise + (threshold - corr(binRise))/slopeRise;
+		int binFall = std::min((int) results.trailing_edge[h], nsamples-1);
+		float slopeFall = 0;
+		if (binFall - 1 >= 0)
+			slopeFall = corr(binFall) - corr(binFall-1);
+		float fittedBinFall = (slopeFall == 0) ? binFall : binFall-1 + (threshold - corr(binFall-1))/slopeFall;
+		// zero of the CFD between binZero-1 and binZero
+		int binZero = results.cfd_time[h];
+		float fittedBinZero = -1;
+		if (binZero < nsamples) {
+			float cfdp = cfd_fraction*corr(binZero-1) - corr(binZero-1-cfd_delay);
+			float cfd = cfd_fraction*corr(binZero) - corr(binZero-cfd_delay);
+			fittedBinZero = binZero-1 + cfdp/(cfdp - cfd); // cfdp > 0 >= cfd
+		}
+		results.time[h] = time*sampling_time;
+		results.leading_edge[h] = fittedBinRise*sampling_time;
+		results.trailing_edge[h] = fittedBinFall*sampling_time;
+		results.tot[h] = (fittedBinFall - fittedBinRise)*sampling_time;
+		results.cfd_time[h] = (fittedBinZero < 0) ? -1 : fittedBinZero*sampling_time;
+	}
+}
+
+void fPulse::extract(const fWaveformBatch& batch, fPulseResults& results, const float* pedestals) const {
+	extract(batch.getSamples(0), batch.getStride(), batch.getNumberOfHits(), batch.getLengths(), results, pedestals);
+}
@@ -0,0 +1,101 @@
+/***********************************************
+ * Pulse features of batches of waveforms
+ *
+ * The quantities of the decoder (the columns of
+ * AHDC::adc) are computed again from the samples
+ * of AHDC::wf, with parameters chosen by the
+ * user :
+ *   - adcOffset : pedestal, mean of the first
+ *     npedestal valid samples, or the pedestal of
+ *     the wire (calibration table)
+ *   - ADC : largest corrected sample
+ *   - integral : sum of the corrected samples
+ *     (max(x - pedestal, 0)) before the trailing
+ *     zeros
+ *   - time : time of the peak, the first bin of
+ *     the peak or the top of the parabola through
+ *     the peak and its neighbours
+ *   - leadingEdgeTime, timeOverThreshold : the
+ *     corrected samples cross fraction*ADC (linear
+ *     fit between two samples, as is_recognized in
+ *     shape.cpp)
+ *   - constantFractionTime : first zero crossing
+ *     after the leading edge of
+ *     cfd_fraction*c[s] - c[s - cfd_delay]
+ * The times are in ns (bin*sampling_time).
+ *
+ * The hits of a fWaveformBatch are processed by
+ * blocks of 64, sample by sample (vectorized
+ * loops), the fits are then done hit by hit on a
+ * few samples.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_PULSE_H
+#define F_PULSE_H
+
+#include "fWaveformBatch.h"
+#include <cstdint>
+
+/** features of fPulseResults, in the order of getFeature */
+enum fPulseFeature {
+	PULSE_ADC,
+	PULSE_INTEGRAL,
+	PULSE_OFFSET,
+	PULSE_TIME,
+	PULSE_LEADING_EDGE,
+	PULSE_TOT,
+	PULSE_CFD,
+	PULSE_NFEATURES
+};
+
+/** algorithm of the time of the peak */
+enum fPulseTimeMode {
+	PULSE_TIME_BIN, ///< first bin of the peak
+	PULSE_TIME_PARABOLA ///< top of the parabola through the peak and its neighbours
+};
+
+/** results of fPulse::extract, one entry per hit */
+struct fPulseResults {
+	fAlignedVector<int32_t> adc; ///< ADC
+	fAlignedVector<float> integral;
+	fAlignedVector<float> adc_offset; ///< pedestal
+	fAlignedVector<float> time; ///< time of the peak (ns)
+	fAlignedVector<float> leading_edge; ///< ns
+	fAlignedVector<float> trailing_edge; ///< ns
+	fAlignedVector<float> tot; ///< trailing_edge - leading_edge
+	fAlignedVector<float> cfd_time; ///< ns, -1 if there is no crossing
+	void resize(int nhits);
+	double getFeature(int feature, int hit) const; ///< feature : fPulseFeature
+	static const char* getFeatureName(int feature); ///< name of the column of AHDC::adc
+};
+
+class fPulse {
+	double fraction; ///< of ADC for the leading and trailing edges, 0.5 by default
+	double cfd_fraction; ///< 0.3 by default
+	int cfd_delay; ///< in samples, 5 by default
+	int npedestal; ///< samples averaged for the pedestal, 1 (first sample) by default
+	double sampling_time; ///< ns per sample, 50 by default
+	fPulseTimeMode time_mode; ///< PULSE_TIME_BIN by default
+public :
+	fPulse();
+	void set_fraction(double f);
+	void set_cfd(double f, int delay);
+	void set_npedestal(int n);
+	void set_sampling_time(double t);
+	void set_time_mode(fPulseTimeMode mode);
+	/**
+	 * features of nhits waveforms of 50 samples
+	 *
+	 * @param samples sample s of hit h at samples[s*stride + h]
+	 * @param lengths number of samples before the trailing zeros of each hit
+	 * @param pedestals one per hit (e.g fCalibration::getPedestals),
+	 * computed from the first samples if nullptr
+	 */
+	void extract(const int16_t* samples, int stride, int nhits, const int16_t* lengths, fPulseResults& results, const float* pedestals = nullptr) const;
+	void extract(const fWaveformBatch& batch, fPulseResults& results, const float* pedestals = nullptr) const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+/***********************************************
+ * Conversions to ROOT objects
+ *
+ * Header only : the f* classes do not depend on
+ * ROOT, only the executables that draw with ROOT
+ * include this file.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_ROOT_H
+#define F_ROOT_H
+
+#include "fH1D.h"
+#include "TH1.h"
+
+/** Copy of a fH1D in a TH1D (contents, under/overflow and statistics) */
+inline TH1D* to_TH1D(fH1D& h, const char* name) {
+	h.fix_range();
+	int nbins = h.getNumberOfBins();
+	TH1D* hist;
+	if (h.getBinning() == BINNING_UNIFORM) {
+		hist = new TH1D(name, h.getTitle().c_str(), nbins, h.getXmin(), h.getXmax());
+	}
+	else {
+		hist = new TH1D(name, h.getTitle().c_str(), nbins, h.getEdges().data());
+	}
+	for (int bin = 0; bin < nbins; bin++) {
+		hist->SetBinContent(bin + 1, h.getBinBufferContent(bin));
+	}
+	hist->SetBinContent(0, h.getUnderflow());
+	hist->SetBinContent(nbins + 1, h.getOverflow());
+	hist->SetEntries(h.getEntries() + h.getUnderflow() + h.getOverflow());
+	double stats[4] = {h.getSumOfWeights(), h.getSumOfWeights(), h.getSum(), h.getSum2()}; // unit weights : sumw2 = sumw
+	hist->PutStats(stats);
+	return hist;
+}
+
+#endif
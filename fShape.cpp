@@ -0,0 +1,163 @@
+/***********************************************
+ * Shape recognition of batches of waveforms
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fShape.h"
+#include <algorithm>
+#include <cmath>
+
+static const int nsamples = fWaveformBatch::nsamples;
+
+// the blocks are also compiled for AVX2 (twice more hits per
+// instruction), the version is chosen when the program starts
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__linux__)
+#define F_SHAPE_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define F_SHAPE_CLONES
+#endif
+
+void fShapeResults::resize(int nhits) {
+	criteria.resize(nhits);
+	nzeros.resize(nhits);
+	adc_peak.resize(nhits);
+	bin_peak.resize(nhits);
+	bin_rise.resize(nhits);
+	bin_fall.resize(nhits);
+	tot.resize(nhits);
+}
+
+bool fShapeResults::is_recognized(int hit) const { return criteria[hit] == SHAPE_ALL;}
+
+fShape::fShape() : max_nzeros(1), min_tot(7), min_peak(200) {}
+
+void fShape::set_max_nzeros(int n) { max_nzeros = n;}
+void fShape::set_min_tot(double tot) { min_tot = tot;}
+void fShape::set_min_peak(int peak) { min_peak = peak;}
+
+/** -1, 0 or 1 : the sign of a product is the product of the signs */
+static inline int sign(int x) { return (x > 0) - (x < 0);}
+
+/**
+ * One step of the zero finder of is_recognized, at bin i :
+ * d0 = df[i-2], d1 = df[i-1], d2 = df[i], d3 = df[i+1].
+ * The bin following a null product is skipped. Nothing is
+ * done if check is 0 (no branch, the loop is vectorized).
+ */
+static inline void zero_step(int d0, int d1, int d2, int d3, int check, int& skip, int& nzeros) {
+	int p = d2*d1;
+	int q = d3*d0;
+	int active = check & !skip;
+	nzeros += active & (p <= 0) & (q < 0);
+	skip = active & (p == 0);
+}
+
+/**
+ * Hits [h0, h0 + m[, the pedestal corrected samples are
+ * max(x - pedestal, 0), the pedestal is the first sample or
+ * the rounded value of pedestals. The float arithmetic of the
+ * fit is written as in is_recognized.
+ */
+F_SHAPE_CLONES
+static void classify_block(const int16_t* samples, int stride, int h0, int m, const float* pedestals, fShapeResults& results) {
+	const int block = 64;
+	int ped[block], peak[block], bpk[block], rise[block], fall[block];
+	int sd0[block], sd1[block], sd2[block], skip[block], nz[block]; // signs of df[s-4], df[s-3], df[s-2]
+	const int16_t* x0 = samples + h0;
+	for (int i = 0; i < m; i++) {
+		ped[i] = (pedestals == nullptr) ? x0[i] : (int) lrintf(pedestals[h0 + i]);
+		int c = x0[i] - ped[i];
+		peak[i] = (c > 0) ? c : 0; // 0 without pedestals
+		bpk[i] = 0;
+		sd0[i] = sd1[i] = sd2[i] = 0;
+		skip[i] = 0;
+		nz[i] = 0;
+	}
+	// pass 1 : derivative df[s-1] = x[s] - x[s-1], zeros and peak
+	for (int s = 1; s < nsamples; s++) {
+		const int16_t* x = samples + s*stride + h0;
+		const int16_t* xp = x - stride;
+		const int check = (s >= 4); // bin s-2 in [2, nsamples-2]
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			int sd3 = sign(x[i] - xp[i]);
+			zero_step(sd0[i], sd1[i], sd2[i], sd3, check, skip[i], nz[i]);
+			sd0[i] = sd1[i];
+			sd1[i] = sd2[i];
+			sd2[i] = sd3;
+			int c = x[i] - ped[i];
+			c = (c > 0) ? c : 0; // no std::max, it prevents the vectorization
+			int pk = peak[i];
+			bpk[i] = (c > pk) ? s : bpk[i];
+			peak[i] = (c > pk) ? c : pk;
+		}
+	}
+	// last bin : df[nsamples-1] = 0
+	#pragma omp simd
+	for (int i = 0; i < m; i++) {
+		zero_step(sd0[i], sd1[i], sd2[i], 0, 1, skip[i], nz[i]);
+	}
+	// pass 2 : crossings of the threshold (0.5*peak, compared in integers)
+	for (int i = 0; i < m; i++) {
+		rise[i] = 0;
+		fall[i] = nsamples; // not found
+	}
+	for (int s = 0; s < nsamples; s++) {
+		const int16_t* x = samples + s*stride + h0;
+		#pragma omp simd
+		for (int i = 0; i < m; i++) {
+			int c = x[i] - ped[i];
+			int c2 = (c > 0) ? 2*c : 0;
+			int pk = peak[i];
+			int before = (s < bpk[i]);
+			// last pass below the threshold before the peak
+			rise[i] = (before & (c2 < pk)) ? s : rise[i];
+			// first pass below the threshold after the peak (a flag
+			// "found" or a second test on bpk is not vectorized)
+			int candidate = s + nsamples*(before | (c2 > pk));
+			fall[i] = (candidate < fall[i]) ? candidate : fall[i];
+		}
+	}
+	// fit of the crossings, a few samples per hit
+	for (int i = 0; i < m; i++) {
+		auto corr = [&] (int bin) { double c = samples[bin*stride + h0 + i] - ped[i]; return (c > 0) ? c : 0.0;};
+		double adc_peak = peak[i];
+		float threshold = 0.5*adc_peak;
+		int binRise = rise[i];
+		float slopeRise = corr(binRise+1) - corr(binRise);
+		float fittedBinRise = (slopeRise == 0) ? binRise : binRise + (threshold - corr(binRise))/slopeRise;
+		int binFall = (fall[i] < nsamples) ? fall[i] : nsamples-1;
+		float slopeFall = 0;
+		if (binFall - 1 >= 0)
+			slopeFall = corr(binFall) - corr(binFall-1);
+		float fittedBinFall = (slopeFall == 0) ? binFall : binFall-1 + (threshold - corr(binFall-1))/slopeFall;
+		float tot = fittedBinFall - fittedBinRise;
+		int h = h0 + i;
+		results.nzeros[h] = nz[i];
+		results.adc_peak[h] = peak[i];
+		results.bin_peak[h] = bpk[i];
+		results.bin_rise[h] = fittedBinRise;
+		results.bin_fall[h] = fittedBinFall;
+		results.tot[h] = tot;
+	}
+}
+
+void fShape::classify(const int16_t* samples, int stride, int nhits, fShapeResults& results, const float* pedestals) const {
+	if ((int) results.criteria.size() < nhits) { results.resize(nhits);}
+	const int block = 64;
+	for (int h0 = 0; h0 < nhits; h0 += block) {
+		classify_block(samples, stride, h0, std::min(block, nhits - h0), pedestals, results);
+	}
+	#pragma omp simd
+	for (int h = 0; h < nhits; h++) {
+		results.criteria[h] = ((results.nzeros[h] <= max_nzeros) ? SHAPE_NZEROS : 0)
+			| ((((double) results.tot[h]) >= min_tot) ? SHAPE_TOT : 0)
+			| ((results.adc_peak[h] >= min_peak) ? SHAPE_PEAK : 0);
+	}
+}
+
+void fShape::classify(const fWaveformBatch& batch, fShapeResults& results, const float* pedestals) const {
+	classify(batch.getSamples(0), batch.getStride(), batch.getNumberOfHits(), results, pedestals);
+}
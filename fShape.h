@@ -0,0 +1,68 @@
+/***********************************************
+ * Shape recognition of batches of waveforms
+ *
+ * Same criteria as is_recognized in shape.cpp
+ * (samples at x = 0, 1, 2...) : number of zeros
+ * of the derivative, time over threshold from
+ * the fitted rise and fall at half the peak, and
+ * peak above the pedestal (first sample, or the
+ * pedestal of a calibration table).
+ *
+ * The hits of a fWaveformBatch are processed by
+ * blocks, sample by sample, in two passes : the
+ * zeros and the peak, then the threshold
+ * crossings. The results are identical to
+ * is_recognized (same float arithmetic).
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_SHAPE_H
+#define F_SHAPE_H
+
+#include "fWaveformBatch.h"
+#include <cstdint>
+
+/** bits of fShapeResults::criteria */
+enum fShapeCriteria {
+	SHAPE_NZEROS = 1, ///< nzeros <= max_nzeros
+	SHAPE_TOT = 2, ///< tot >= min_tot
+	SHAPE_PEAK = 4, ///< adc_peak >= min_peak
+	SHAPE_ALL = 7
+};
+
+/** results of fShape::classify, one entry per hit */
+struct fShapeResults {
+	fAlignedVector<uint8_t> criteria; ///< bitmask of fShapeCriteria
+	fAlignedVector<int16_t> nzeros; ///< zeros of the derivative
+	fAlignedVector<int32_t> adc_peak; ///< largest sample minus the pedestal
+	fAlignedVector<int16_t> bin_peak; ///< first bin of the peak
+	fAlignedVector<float> bin_rise; ///< fitted bin of the leading edge
+	fAlignedVector<float> bin_fall; ///< fitted bin of the trailing edge
+	fAlignedVector<float> tot; ///< bin_fall - bin_rise
+	void resize(int nhits);
+	bool is_recognized(int hit) const; ///< all the criteria are satisfied
+};
+
+class fShape {
+	int max_nzeros; ///< 1 by default
+	double min_tot; ///< 7 by default
+	int min_peak; ///< 200 by default
+public :
+	fShape();
+	void set_max_nzeros(int n);
+	void set_min_tot(double tot);
+	void set_min_peak(int peak);
+	/**
+	 * classify nhits waveforms of 50 samples
+	 *
+	 * @param samples sample s of hit h at samples[s*stride + h]
+	 * @param pedestals one per hit (e.g fCalibration::getPedestals),
+	 * rounded to the nearest integer, the first sample if nullptr
+	 */
+	void classify(const int16_t* samples, int stride, int nhits, fShapeResults& results, const float* pedestals = nullptr) const;
+	void classify(const fWaveformBatch& batch, fShapeResults& results, const float* pedestals = nullptr) const;
+};
+
+#endif
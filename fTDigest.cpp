@@ -0,0 +1,151 @@
+/***********************************************
+ * Streaming quantile sketch (merging t-digest)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fTDigest.h"
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <limits>
+
+fTDigest::fTDigest(double _compression) : compression(_compression), total(0), xmin(0), xmax(0) {}
+
+void fTDigest::add(double x, double w) {
+	if (!std::isfinite(x) || !(w > 0)) {return ;}
+	if (total == 0) {
+		xmin = x;
+		xmax = x;
+	}
+	xmin = std::min(xmin, x);
+	xmax = std::max(xmax, x);
+	buffer_x.push_back(x);
+	buffer_w.push_back(w);
+	total += w;
+	if (buffer_x.size() >= 5*compression) { compress();}
+}
+
+/**
+ * Sort the centroids and the buffer together, then merge
+ * neighbours as long as the merged centroid spans less
+ * than one unit of the scale function
+ * k(q) = compression/(2 pi) asin(2q - 1)
+ */
+void fTDigest::compress() const {
+	if (buffer_x.empty()) {return ;}
+	std::vector<std::pair<double, double>> all;
+	all.reserve(means.size() + buffer_x.size());
+	for (int i = 0; i < (int) means.size(); i++) {
+		all.push_back({means[i], weights[i]});
+	}
+	for (int i = 0; i < (int) buffer_x.size(); i++) {
+		all.push_back({buffer_x[i], buffer_w[i]});
+	}
+	buffer_x.clear();
+	buffer_w.clear();
+	std::sort(all.begin(), all.end());
+	auto k = [this] (double q) { return compression/(2*M_PI)*std::asin(2*q - 1);};
+	// k(q) + 1 is clamped to k(1) : beyond, the sine comes back down and the limit too
+	auto kinv = [this] (double kq) { return 0.5*(std::sin(std::min(kq, compression/4)*2*M_PI/compression) + 1);};
+	means.clear();
+	weights.clear();
+	double wsofar = 0; // weight before the current centroid
+	double cur_mean = all[0].first;
+	double cur_w = all[0].second;
+	double wlimit = total*kinv(k(0) + 1);
+	for (int i = 1; i < (int) all.size(); i++) {
+		double proposed = cur_w + all[i].second;
+		if (wsofar + proposed <= wlimit) {
+			cur_mean += (all[i].first - cur_mean)*all[i].second/proposed;
+			cur_w = proposed;
+		}
+		else {
+			means.push_back(cur_mean);
+			weights.push_back(cur_w);
+			wsofar += cur_w;
+			wlimit = total*kinv(k(std::min(wsofar/total, 1.0)) + 1);
+			cur_mean = all[i].first;
+			cur_w = all[i].second;
+		}
+	}
+	means.push_back(cur_mean);
+	weights.push_back(cur_w);
+}
+
+void fTDigest::merge(const fTDigest& other) {
+	if (other.total == 0) {return ;}
+	if (total == 0) {
+		xmin = other.xmin;
+		xmax = other.xmax;
+	}
+	xmin = std::min(xmin, other.xmin);
+	xmax = std::max(xmax, other.xmax);
+	for (int i = 0; i < (int) other.means.size(); i++) {
+		buffer_x.push_back(other.means[i]);
+		buffer_w.push_back(other.weights[i]);
+	}
+	buffer_x.insert(buffer_x.end(), other.buffer_x.begin(), other.buffer_x.end());
+	buffer_w.insert(buffer_w.end(), other.buffer_w.begin(), other.buffer_w.end());
+	total += other.total;
+	compress();
+}
+
+/**
+ * Linear interpolation between the centers of the
+ * centroids, and between the extreme centroids and
+ * the min/max values in the tails.
+ */
+double fTDigest::quantile(double q) const {
+	compress();
+	if (total == 0) { return std::numeric_limits<double>::quiet_NaN();}
+	if (q <= 0) { return xmin;}
+	if (q >= 1) { return xmax;}
+	int n = means.size();
+	double target = q*total;
+	if (target < 0.5*weights[0]) {
+		return xmin + (means[0] - xmin)*target/(0.5*weights[0]);
+	}
+	double cum = 0;
+	for (int i = 0; i < n - 1; i++) {
+		double center = cum + 0.5*weights[i];
+		double next_center = cum + weights[i] + 0.5*weights[i+1];
+		if (target < next_center) {
+			return means[i] + (means[i+1] - means[i])*(target - center)/(next_center - center);
+		}
+		cum += weights[i];
+	}
+	double last_center = total - 0.5*weights[n-1];
+	return means[n-1] + (xmax - means[n-1])*(target - last_center)/(0.5*weights[n-1]);
+}
+
+double fTDigest::getTotalWeight() const { return total;}
+double fTDigest::getCompression() const { return compression;}
+double fTDigest::getMin() const { return xmin;}
+double fTDigest::getMax() const { return xmax;}
+int fTDigest::getNumberOfCentroids() const { compress(); return means.size();}
+const std::vector<double>& fTDigest::getMeans() const { compress(); return means;}
+const std::vector<double>& fTDigest::getWeights() const { compress(); return weights;}
+
+/**
+ * Restore a digest (e.g read from a file)
+ */
+void fTDigest::set_centroids(const std::vector<double>& _means, const std::vector<double>& _weights, double _xmin, double _xmax) {
+	reset();
+	means = _means;
+	weights = _weights;
+	for (double w : weights) { total += w;}
+	xmin = _xmin;
+	xmax = _xmax;
+}
+
+void fTDigest::reset() {
+	means.clear();
+	weights.clear();
+	buffer_x.clear();
+	buffer_w.clear();
+	total = 0;
+	xmin = 0;
+	xmax = 0;
+}
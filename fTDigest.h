@@ -0,0 +1,51 @@
+/***********************************************
+ * Streaming quantile sketch (merging t-digest)
+ *
+ * The values are summarized by fewer than
+ * 'compression' weighted centroids (about 0.6
+ * compression in practice), smaller ones
+ * near the tails so that extreme quantiles stay
+ * accurate. Two digests can be merged (threads,
+ * files).
+ *
+ * T. Dunning, O. Ertl, "Computing Extremely
+ * Accurate Quantiles Using t-Digests" (2019)
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_TDIGEST_H
+#define F_TDIGEST_H
+
+#include <vector>
+
+class fTDigest {
+private :
+	double compression; ///< delta : bound on the number of centroids
+	// the buffer is merged lazily, also by the const getters
+	mutable std::vector<double> means; ///< centroid means, sorted
+	mutable std::vector<double> weights; ///< centroid weights
+	mutable std::vector<double> buffer_x; ///< values not merged yet
+	mutable std::vector<double> buffer_w; ///< weights of the values not merged yet
+	double total; ///< total weight (centroids + buffer)
+	double xmin; ///< smallest value
+	double xmax; ///< largest value
+	void compress() const; ///< merge the buffer into the centroids
+public :
+	fTDigest(double _compression = 200);
+	void add(double x, double w = 1.0);
+	void merge(const fTDigest& other);
+	double quantile(double q) const; ///< q in [0, 1], nan if empty
+	double getTotalWeight() const;
+	double getCompression() const;
+	double getMin() const;
+	double getMax() const;
+	int getNumberOfCentroids() const; ///< after merging the buffer
+	const std::vector<double>& getMeans() const; ///< after merging the buffer
+	const std::vector<double>& getWeights() const; ///< after merging the buffer
+	void set_centroids(const std::vector<double>& _means, const std::vector<double>& _weights, double _xmin, double _xmax);
+	void reset();
+};
+
+#endif
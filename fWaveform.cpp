@@ -0,0 +1,49 @@
+/***********************************************
+ * Typed access to the AHDC::wf bank
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fWaveform.h"
+#include <cstdio>
+
+AhdcWaveform::AhdcWaveform(hipo::schema& schema) : layer(0), component(0) {
+	item_layer = schema.getEntryOrder("layer");
+	item_component = schema.getEntryOrder("component");
+	valid = (item_layer >= 0) && (item_component >= 0);
+	for (int i = 0; i < nsamples; i++) {
+		char buffer[50];
+		sprintf(buffer, "s%d", i + 1);
+		item_samples[i] = schema.getEntryOrder(buffer);
+		valid = valid && (item_samples[i] >= 0);
+		samples[i] = 0;
+	}
+	if (!valid) {
+		printf("AhdcWaveform : the bank has not the columns of AHDC::wf\n");
+	}
+}
+
+bool AhdcWaveform::is_valid() const { return valid;}
+
+void AhdcWaveform::read(hipo::bank& bank, int row) {
+	if (!valid) {return ;}
+	layer = bank.getInt(item_layer, row);
+	component = bank.getInt(item_component, row);
+	for (int i = 0; i < nsamples; i++) {
+		samples[i] = bank.getShort(item_samples[i], row);
+	}
+}
+
+int AhdcWaveform::getLayer() const { return layer;}
+int AhdcWaveform::getComponent() const { return component;}
+const int16_t* AhdcWaveform::data() const { return samples;}
+int AhdcWaveform::size() const { return nsamples;}
+int16_t AhdcWaveform::operator[](int i) const { return samples[i];}
+
+int AhdcWaveform::getLength() const {
+	for (int i = nsamples - 1; i >= 0; i--) {
+		if (samples[i] != 0) { return i + 1;}
+	}
+	return nsamples;
+}
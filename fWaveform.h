@@ -0,0 +1,50 @@
+/***********************************************
+ * Typed access to the AHDC::wf bank
+ *
+ * The positions of the columns (layer, component,
+ * s1 ... s50) are resolved once from the schema,
+ * a row is then read without any string formatting
+ * or name lookup. The samples of a row are gathered
+ * in a contiguous int16_t array (the bank stores
+ * the columns one after the other).
+ *
+ * e.g
+ *     AhdcWaveform wf(pipeline.getBank(1).getSchema());
+ *     ...
+ *     wf.read(banklist[1], col);
+ *     for (int i = 0; i < wf.size(); i++) { wf[i] ...}
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_WAVEFORM_H
+#define F_WAVEFORM_H
+
+#include "reader.h"
+#include <cstdint>
+
+class AhdcWaveform {
+public :
+	static const int nsamples = 50; ///< number of samples of a waveform
+private :
+	int item_layer; ///< column number of layer
+	int item_component; ///< column number of component
+	int item_samples[nsamples]; ///< column numbers of s1 ... s50
+	bool valid; ///< all the columns were found
+	int layer;
+	int component;
+	alignas(32) int16_t samples[nsamples]; ///< samples of the last row read
+public :
+	AhdcWaveform(hipo::schema& schema); ///< resolve the columns
+	bool is_valid() const;
+	void read(hipo::bank& bank, int row); ///< gather the samples of a row
+	int getLayer() const;
+	int getComponent() const;
+	const int16_t* data() const; ///< s1 ... s50
+	int size() const;
+	int16_t operator[](int i) const; ///< sample s(i+1)
+	int getLength() const; ///< number of samples before the trailing zeros (zero suppression), 50 if all are 0
+};
+
+#endif
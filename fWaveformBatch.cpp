@@ -0,0 +1,118 @@
+/***********************************************
+ * Waveforms of many events in a structure of
+ * arrays
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#include "fWaveformBatch.h"
+#include <cstdio>
+#include <algorithm>
+
+fWaveformBatch::fWaveformBatch(hipo::schema& schema, int capacity) : nhits(0), stride(0) {
+	item_layer = schema.getEntryOrder("layer");
+	item_component = schema.getEntryOrder("component");
+	item_timestamp = schema.getEntryOrder("timestamp");
+	valid = (item_layer >= 0) && (item_component >= 0);
+	for (int i = 0; i < nsamples; i++) {
+		char buffer[50];
+		sprintf(buffer, "s%d", i + 1);
+		item_samples[i] = schema.getEntryOrder(buffer);
+		valid = valid && (item_samples[i] >= 0);
+	}
+	if (!valid) {
+		printf("fWaveformBatch : the bank has not the columns of AHDC::wf\n");
+	}
+	event_offset.push_back(0);
+	reserve(capacity);
+}
+
+bool fWaveformBatch::is_valid() const { return valid;}
+
+std::vector<std::string> fWaveformBatch::getColumns() {
+	std::vector<std::string> columns = {"layer", "component"};
+	for (int i = 0; i < nsamples; i++) {
+		columns.push_back("s" + std::to_string(i + 1));
+	}
+	return columns;
+}
+
+/**
+ * The stride changes : the samples already decoded
+ * are moved row by row
+ */
+void fWaveformBatch::reserve(int capacity) {
+	int new_stride = ((std::max(capacity, 1) + 31)/32)*32;
+	if (new_stride <= stride) {return ;}
+	fAlignedVector<int16_t> new_samples(nsamples*new_stride, 0);
+	for (int s = 0; s < nsamples; s++) {
+		std::copy(samples.begin() + s*stride, samples.begin() + s*stride + nhits, new_samples.begin() + s*new_stride);
+	}
+	samples.swap(new_samples);
+	stride = new_stride;
+	layer.resize(stride, 0);
+	component.resize(stride, 0);
+	timestamp.resize(stride, 0);
+	length.resize(stride, 0);
+}
+
+/**
+ * The bank stores each column contiguously, the sample
+ * s of all the rows goes to the row s of the matrix.
+ *
+ * @note the samples are still read one by one with
+ * bank.getShort (the bank gives no pointer to a column),
+ * in the order of the bank : column after column
+ */
+int fWaveformBatch::add_event(hipo::bank& bank, long event) {
+	int nrows = valid ? bank.getRows() : 0;
+	if (nhits + nrows > stride) { reserve(std::max(2*stride, nhits + nrows));}
+	for (int row = 0; row < nrows; row++) {
+		layer[nhits + row] = bank.getInt(item_layer, row);
+		component[nhits + row] = bank.getInt(item_component, row);
+		timestamp[nhits + row] = (item_timestamp >= 0) ? bank.getLong(item_timestamp, row) : 0;
+	}
+	for (int s = 0; s < nsamples; s++) {
+		int16_t* dest = samples.data() + s*stride + nhits;
+		for (int row = 0; row < nrows; row++) {
+			dest[row] = bank.getShort(item_samples[s], row);
+		}
+	}
+	// length before the trailing zeros, across the hits
+	int16_t* len = length.data() + nhits;
+	std::fill(len, len + nrows, 0);
+	for (int s = 0; s < nsamples; s++) {
+		const int16_t* src = samples.data() + s*stride + nhits;
+		#pragma omp simd
+		for (int row = 0; row < nrows; row++) {
+			len[row] = (src[row] != 0) ? s + 1 : len[row];
+		}
+	}
+	#pragma omp simd
+	for (int row = 0; row < nrows; row++) {
+		len[row] = (len[row] == 0) ? nsamples : len[row];
+	}
+	nhits += nrows;
+	event_offset.push_back(nhits);
+	event_number.push_back(event);
+	return nrows;
+}
+
+void fWaveformBatch::clear() {
+	nhits = 0;
+	event_offset.assign(1, 0);
+	event_number.clear();
+}
+
+int fWaveformBatch::getNumberOfHits() const { return nhits;}
+int fWaveformBatch::getNumberOfEvents() const { return event_number.size();}
+int fWaveformBatch::getStride() const { return stride;}
+const int16_t* fWaveformBatch::getSamples(int s) const { return samples.data() + s*stride;}
+int16_t fWaveformBatch::getSample(int hit, int s) const { return samples[s*stride + hit];}
+const int16_t* fWaveformBatch::getLayers() const { return layer.data();}
+const int16_t* fWaveformBatch::getComponents() const { return component.data();}
+const int64_t* fWaveformBatch::getTimestamps() const { return timestamp.data();}
+const int16_t* fWaveformBatch::getLengths() const { return length.data();}
+int fWaveformBatch::getFirstHit(int ev) const { return event_offset[ev];}
+long fWaveformBatch::getEventNumber(int ev) const { return event_number[ev];}
@@ -0,0 +1,91 @@
+/***********************************************
+ * Waveforms of many events in a structure of
+ * arrays
+ *
+ * The AHDC::wf rows of a batch of events are
+ * decoded in a matrix of int16_t samples stored
+ * sample by sample : the sample s of all the hits
+ * is contiguous (getSamples(s)), so that a kernel
+ * processes as many hits as the vector width at
+ * once. The layer, component, timestamp and
+ * length of each hit are stored in parallel
+ * arrays, the hits of an event are
+ * [getFirstHit(ev), getFirstHit(ev+1)[.
+ *
+ *             hit 0   hit 1   ...  (stride)
+ *   sample 0    .       .
+ *   sample 1    .       .
+ *   ...
+ *   sample 49   .       .
+ *
+ * All the arrays are aligned on 64 bytes, the
+ * stride is a multiple of 32 samples.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * ********************************************/
+
+#ifndef F_WAVEFORM_BATCH_H
+#define F_WAVEFORM_BATCH_H
+
+#include "reader.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <new>
+
+/** allocator of arrays aligned on Align bytes */
+template <typename T, std::size_t Align = 64>
+struct fAlignedAllocator {
+	using value_type = T;
+	template <typename U> struct rebind { using other = fAlignedAllocator<U, Align>;};
+	fAlignedAllocator() {}
+	template <typename U> fAlignedAllocator(const fAlignedAllocator<U, Align>&) {}
+	T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Align)));}
+	void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t(Align));}
+	bool operator==(const fAlignedAllocator&) const { return true;}
+	bool operator!=(const fAlignedAllocator&) const { return false;}
+};
+
+template <typename T>
+using fAlignedVector = std::vector<T, fAlignedAllocator<T>>;
+
+class fWaveformBatch {
+public :
+	static const int nsamples = 50; ///< number of samples of a waveform
+private :
+	int item_layer; ///< column numbers in AHDC::wf
+	int item_component;
+	int item_timestamp; ///< -1 if the bank has no timestamp
+	int item_samples[nsamples];
+	bool valid; ///< all the columns were found (except the timestamp)
+	int nhits; ///< number of hits in the batch
+	int stride; ///< capacity, distance between two samples of a hit
+	fAlignedVector<int16_t> samples; ///< nsamples x stride
+	fAlignedVector<int16_t> layer;
+	fAlignedVector<int16_t> component;
+	fAlignedVector<int64_t> timestamp;
+	fAlignedVector<int16_t> length; ///< number of samples before the trailing zeros, 50 if all are 0
+	std::vector<int> event_offset; ///< first hit of each event, and nhits at the end
+	std::vector<long> event_number; ///< number of each event in the file
+	void reserve(int capacity); ///< keep the hits already decoded
+public :
+	fWaveformBatch(hipo::schema& schema, int capacity = 4096); ///< resolve the columns
+	bool is_valid() const;
+	static std::vector<std::string> getColumns(); ///< columns of AHDC::wf required by add_event (the timestamp is optional)
+	int add_event(hipo::bank& bank, long event); ///< decode all the rows of an event, return the number of hits added
+	void clear(); ///< keep the memory
+	int getNumberOfHits() const;
+	int getNumberOfEvents() const;
+	int getStride() const;
+	const int16_t* getSamples(int s) const; ///< sample s of all the hits
+	int16_t getSample(int hit, int s) const;
+	const int16_t* getLayers() const;
+	const int16_t* getComponents() const;
+	const int64_t* getTimestamps() const;
+	const int16_t* getLengths() const;
+	int getFirstHit(int ev) const; ///< ev in [0, nevents], getFirstHit(nevents) = nhits
+	long getEventNumber(int ev) const;
+};
+
+#endif
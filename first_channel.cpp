@@ -18,35 +18,34 @@
 #include "TStyle.h"
 #include "TString.h"
 
+#include "fH1D.h"
+#include "fRoot.h"
+#include "fPipeline.h"
+#include "fHistIO.h"
+
 
 int main(int argc, char const *argv[]){
 	
-	if (argc < 2) {
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	if (args.size() < 2) {
 		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./first_channel.exe filename [options]\n%s", fPipeline::getOptionsUsage());
 		return 0;
 	}
 
 	// open file and read bank
-	const char* filename = argv[1];
-	hipo::reader  reader(filename);
-	//hipo::banklist banklist = reader.getBanks({"AHDC::adc","AHDC::wf"});
-	hipo::banklist banklist = reader.getBanks({"AHDC::adc"});
-	long unsigned int nEvent = 0;
+	const char* filename = args[1];
+	fPipeline pipeline(filename, {{"AHDC::adc", {"time"}}});
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+	const int item_time = pipeline.getColumn(0, "time");
 
-	TH1D* hist1d_time = new TH1D("hist1d_time", "hist1d_time", 100, 0, 5000);	
-	TH1D* hist1d_leadingEdgeTime = new TH1D("hist1d_leadingEdgeTime", "hist1d_leadingEdgeTime", 100, 0, 5000);	
+	fH1D model_time("hist1d_time", 100, 0, 5000);
 	// loop over events
-	while( reader.next(banklist)){
-		//printf(" ======= EVENT %ld =========\n", nEvent);
-		if (nEvent > 20000) { break;} // process only 20k events
-		for(int col = 0; col < banklist[0].getRows(); col++){ // loop over columns of AHDC::wf 
-			// AHDC::wf --> samples
-			//int layer = banklist[1].getInt("layer", col);
-			//int component = banklist[1].getInt("component", col);
-			int time = banklist[0].getInt("time", col);
-			//long timestamp = banklist[1].getLong("timestamp", col);
-			//printf("%d  ", time);
-			//printf("%ld  ", timestamp);
+	fH1D h_time = pipeline.run<fH1D>(model_time,
+		[item_time] (fH1D& hist, hipo::banklist& banklist, long nEvent) {
+		for(int col = 0; col < banklist[0].getRows(); col++){ // loop over columns of AHDC::adc
+			int time = banklist[0].getInt(item_time, col);
 			// AHDC::adc  --> decoded outputs
 			//double adcMax = banklist[0].getInt("ADC", col);
 			//double integral = banklist[0].getInt("integral", col);
@@ -55,11 +54,15 @@ int main(int argc, char const *argv[]){
 			//double leadingEdgeTime = banklist[0].getFloat("leadingEdgeTime", col)/50.0;
 			//double timeOT = banklist[0].getInt("timeOverThreshold", col);
 			//double timeCFD = banklist[0].getInt("constantFractionTime", col);
-			hist1d_time->Fill(time);
-			//hist1d_leadingEdgeTime->Fill(leadingEdgeTime);
+			hist.fill(time);
 		}
-		nEvent++;
-	}
+	},
+	[] (fH1D& hist, const fH1D& other) { hist.merge(other);});
+	// histogram of the shard, see hmerge.exe
+	fHistWriter writer;
+	writer.add(&h_time);
+	writer.write("hist1d_time" + options.getSuffix() + ".fhist");
+	TH1D* hist1d_time = to_TH1D(h_time, "hist1d_time");
 	TCanvas* canvas1 = new TCanvas("c1","c1 title",1200, 800);
 	gStyle->SetOptStat("nemruo");
 	//canvas1->Divide(2,1);
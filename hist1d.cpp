@@ -1,6 +1,20 @@
 /****************************************************
- * Generate a 1D histogram from bankname, quantity
- * to histogram, lower and upper limit
+ * Generate 1D histograms of the columns of the
+ * banks, in one pass over the file
+ *
+ * Each histogram is described by a line
+ *     name ; bank ; expression ; nbins [xmin xmax] [; cut]
+ * e.g
+ *     adc_51 ; AHDC::adc ; ADC ; 100 0 4000 ; layer == 51 && ADC > 200
+ *     let ; AHDC::adc ; leadingEdgeTime/50 ; 100
+ * given on the command line or in a file (one line
+ * per histogram, # for the comments). The
+ * expression and the cut are formulas over the
+ * columns of the bank (see fFormula), only the rows
+ * that pass the cut are filled.
+ *
+ * Without limits, the range is chosen from the
+ * first entries (see fH1D::enable_auto_range)
  *
  * @author Felix Touchte Codjo
  * @date March 29, 2025
@@ -10,6 +24,9 @@
 
 #include <string>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 #include "TH1.h"
 #include "TH2.h"
@@ -19,63 +36,254 @@
 #include "TStyle.h"
 #include "TString.h"
 
+#include "fH1D.h"
+#include "fRoot.h"
+#include "fPipeline.h"
+#include "fHistIO.h"
+#include "fFormula.h"
+
+/** one histogram of the specification */
+struct HistSpec {
+	std::string name;
+	std::string bank;
+	fFormula expression;
+	fFormula cut; ///< empty : all the rows are filled
+	int nbins = 0;
+	double xmin = 0;
+	double xmax = 0;
+	bool auto_range = true;
+	int bank_index = -1; ///< in the banklist of the pipeline
+};
+
+static std::string trim(std::string s) {
+	size_t first = s.find_first_not_of(" \t\r\n");
+	size_t last = s.find_last_not_of(" \t\r\n");
+	return (first == std::string::npos) ? "" : s.substr(first, last - first + 1);
+}
+
+/** name ; bank ; expression ; nbins [xmin xmax] [; cut] */
+static bool parse_spec(std::string line, HistSpec& spec) {
+	std::vector<std::string> fields;
+	std::stringstream stream(line);
+	std::string field;
+	while (std::getline(stream, field, ';')) {
+		fields.push_back(trim(field));
+	}
+	if ((fields.size() < 4) || (fields.size() > 5)) {
+		printf("Invalid histogram : %s\n", line.c_str());
+		return false;
+	}
+	spec.name = fields[0];
+	spec.bank = fields[1];
+	spec.expression = fFormula(fields[2]);
+	spec.cut = fFormula((fields.size() == 5) ? fields[4] : "");
+	int nread = sscanf(fields[3].c_str(), "%d %lf %lf", &spec.nbins, &spec.xmin, &spec.xmax);
+	spec.auto_range = (nread == 1);
+	bool ok = !spec.name.empty() && !spec.bank.empty() && (spec.nbins > 0) && ((nread == 1) || (nread == 3));
+	if (!ok) {
+		printf("Invalid histogram : %s\n", line.c_str());
+		return false;
+	}
+	for (fFormula* formula : {&spec.expression, &spec.cut}) {
+		if (!formula->is_valid()) {
+			printf("%s : %s\n", spec.name.c_str(), formula->getError().c_str());
+			return false;
+		}
+	}
+	if (spec.expression.is_empty()) {
+		printf("%s : no expression\n", spec.name.c_str());
+		return false;
+	}
+	return true;
+}
+
+/** a line with ';' or a file of lines */
+static bool read_specs(std::string arg, std::vector<HistSpec>& specs) {
+	std::vector<std::string> lines;
+	if (arg.find(';') != std::string::npos) {
+		lines.push_back(arg);
+	}
+	else {
+		std::ifstream file(arg);
+		if (!file.is_open()) {
+			printf("Cannot open %s\n", arg.c_str());
+			return false;
+		}
+		std::string line;
+		while (std::getline(file, line)) {
+			line = trim(line.substr(0, line.find('#')));
+			if (!line.empty()) { lines.push_back(line);}
+		}
+	}
+	for (std::string line : lines) {
+		HistSpec spec;
+		if (!parse_spec(line, spec)) { return false;}
+		specs.push_back(spec);
+	}
+	return true;
+}
+
+/** state of a thread */
+struct Hist1dState {
+	std::vector<HistSpec> specs; ///< the formulas keep work arrays
+	std::vector<fH1D> hists;
+	std::vector<double> values;
+	std::vector<double> pass;
+};
+
+/** values of the rows that pass the cut, in state.values */
+static int evaluate(HistSpec& spec, hipo::bank& bank, std::vector<double>& values, std::vector<double>& pass) {
+	spec.expression.evaluate(bank, values);
+	int n = values.size();
+	if (spec.cut.is_empty()) { return n;}
+	spec.cut.evaluate(bank, pass);
+	int m = 0;
+	for (int row = 0; row < n; row++) {
+		values[m] = values[row];
+		m += (pass[row] != 0);
+	}
+	return m;
+}
 
 int main(int argc, char const *argv[]){
-	
-	if (argc >= 7) { 
-		// open file and read bank
-		const char* filename = argv[1];
-		const char* bankname = argv[2];
-		const char* attribut_name = argv[3];
-		const char* type = argv[4];
-		int Nbins = std::atoi(argv[5]);
-		double xmin = std::atof(argv[6]);
-		double xmax = std::atof(argv[7]);
-		
+
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	int nargs = args.size();
+	// former usage : filename bankname attribut type Nbins [lower_value upper_value]
+	bool single = ((nargs == 6) || (nargs >= 8)) && (args[4][0] == '-');
+	if (nargs < 3) {
+		printf("Please, provide a filename and the histograms...\n");
+		printf("Usage :\n");
+		printf("   ./hist1d.exe filename histogram [histogram ...] [options]\n");
+		printf("      histogram : \"name ; bank ; expression ; nbins [xmin xmax] [; cut]\" or a file of such lines\n");
+		printf("      e.g ./hist1d.exe file.hipo \"adc_51 ; AHDC::adc ; ADC ; 100 0 4000 ; layer == 51 && ADC > 200\"\n");
+		printf("   ./hist1d.exe filename bankname attribut type Nbins [lower_value upper_value] [options]\n");
+		printf("      e.g ./hist1d.exe file.hipo AHDC::adc time -f 100 0.0 100.0 (-f : divided by 50)\n");
+		printf("   without the limits, the range is chosen from the first 10000 entries\n");
+		printf("%s", fPipeline::getOptionsUsage());
+		return 0;
+	}
+	const char* filename = args[1];
+	std::vector<HistSpec> specs;
+	if (single) {
+		std::string attribut_name = args[3];
+		std::string type = args[4];
+		if ((type != "-f") && (type != "-i")) {
+			printf("Unknown type %s, -f or -i\n", type.c_str());
+			return 0;
+		}
+		std::string line = "hist1d_" + attribut_name + " ; " + args[2] + " ; " + attribut_name + ((type == "-f") ? "/50.0" : "") + " ; " + args[5];
+		if (nargs >= 8) {
+			line += std::string(" ") + args[6] + " " + args[7];
+		}
+		if (!read_specs(line, specs)) { return 0;}
+	}
+	else {
+		for (int i = 2; i < nargs; i++) {
+			if (!read_specs(args[i], specs)) { return 0;}
+		}
+	}
+
+	// only the columns used by the formulas are read
+	std::vector<fColumns> projection;
+	for (const HistSpec& spec : specs) {
+		fColumns columns = {spec.bank, spec.expression.getColumns()};
+		for (const std::string& column : spec.cut.getColumns()) {
+			columns.columns.push_back(column);
+		}
+		fPipeline::add_columns(projection, columns);
+	}
+	fPipeline pipeline(filename, projection);
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+	for (HistSpec& spec : specs) {
+		spec.bank_index = pipeline.getBankIndex(spec.bank);
+		hipo::schema& schema = pipeline.getBank(spec.bank_index).getSchema();
+		if (!spec.expression.compile(schema) || !spec.cut.compile(schema)) {
+			printf("%s : %s%s\n", spec.name.c_str(), spec.expression.getError().c_str(), spec.cut.getError().c_str());
+			return 0;
+		}
+	}
+
+	// the threads (and the shards) must share the range : it is chosen from the first entries of the file
+	std::vector<fH1D> first_entries;
+	bool auto_range = false;
+	for (const HistSpec& spec : specs) {
+		first_entries.push_back(fH1D(spec.name, spec.nbins, 0, 0));
+		if (spec.auto_range) {
+			first_entries.back().enable_auto_range(10000);
+			auto_range = true;
+		}
+	}
+	if (auto_range) {
 		hipo::reader  reader(filename);
-		hipo::banklist banklist = reader.getBanks({bankname});
+		std::vector<std::string> banknames;
+		for (const fColumns& columns : projection) {
+			banknames.push_back(columns.bank);
+		}
+		hipo::banklist banklist = reader.getBanks(banknames);
+		std::vector<double> values, pass;
 		long unsigned int nEvent = 0;
-		
-		char buffer[50];
-		sprintf(buffer, "hist1d_%s", attribut_name);
-		TH1D* hist1d = new TH1D(buffer, buffer, Nbins, xmin, xmax);	
-		// loop over events
-		while( reader.next(banklist)){
-			//printf(" ======= EVENT %ld =========\n", nEvent);
-			if (nEvent > 20000) { break;} // process only 20k events
-			for(int col = 0; col < banklist[0].getRows(); col++){ // loop over columns of the bankname
-				if (std::string(type) == "-f") {
-					double value = banklist[0].getFloat(attribut_name, col)/50.0;
-					hist1d->Fill(value);
-				}
-				else if (std::string(type) == "-i") {
-					double value = banklist[0].getInt(attribut_name, col);
-					hist1d->Fill(value);
-				}
-				else {
-					// do nothing
-				}
+		bool fixed = false;
+		while (!fixed && (nEvent <= 20000) && reader.next(banklist)) {
+			fixed = true;
+			for (int i = 0; i < (int) specs.size(); i++) {
+				if (!specs[i].auto_range || first_entries[i].is_range_fixed()) { continue;}
+				int n = evaluate(specs[i], banklist[specs[i].bank_index], values, pass);
+				first_entries[i].fill_batch(values.data(), n);
+				fixed = fixed && first_entries[i].is_range_fixed();
 			}
 			nEvent++;
 		}
+		for (int i = 0; i < (int) specs.size(); i++) {
+			if (!specs[i].auto_range) { continue;}
+			first_entries[i].fix_range();
+			specs[i].xmin = first_entries[i].getXmin();
+			specs[i].xmax = first_entries[i].getXmax();
+			printf("Range of %s : %d bins in [%lf, %lf]\n", specs[i].name.c_str(), specs[i].nbins, specs[i].xmin, specs[i].xmax);
+		}
+	}
+	Hist1dState model;
+	model.specs = specs;
+	for (const HistSpec& spec : specs) {
+		model.hists.push_back(fH1D(spec.name, spec.nbins, spec.xmin, spec.xmax));
+	}
+	// loop over events, all the histograms are filled in the same pass
+	Hist1dState result = pipeline.run<Hist1dState>(model,
+		[] (Hist1dState& state, hipo::banklist& banklist, long nEvent) {
+			for (int i = 0; i < (int) state.specs.size(); i++) {
+				int n = evaluate(state.specs[i], banklist[state.specs[i].bank_index], state.values, state.pass);
+				state.hists[i].fill_batch(state.values.data(), n);
+			}
+		},
+		[] (Hist1dState& state, const Hist1dState& other) {
+			for (int i = 0; i < (int) state.hists.size(); i++) {
+				state.hists[i].merge(other.hists[i]);
+			}
+		});
+	// histograms of the shard, see hmerge.exe
+	std::string prefix = single ? std::string(args[2]) + "_" + args[3] : "hist1d";
+	fHistWriter writer;
+	for (const fH1D& h : result.hists) {
+		writer.add(&h);
+	}
+	writer.write(prefix + options.getSuffix() + ".fhist");
+	gStyle->SetOptStat("nemruo");
+	for (int i = 0; i < (int) specs.size(); i++) {
+		TH1D* hist1d = to_TH1D(result.hists[i], specs[i].name.c_str());
 		TCanvas* canvas1 = new TCanvas("c1","c1 title",1300, 800);
-		gStyle->SetOptStat("nemruo");
-		hist1d->GetXaxis()->SetTitle(attribut_name);
+		std::string xtitle = specs[i].expression.getText();
+		if (!specs[i].cut.is_empty()) {
+			xtitle += " {" + specs[i].cut.getText() + "}";
+		}
+		hist1d->GetXaxis()->SetTitle(single ? args[3] : xtitle.c_str());
 		hist1d->GetXaxis()->SetTitleSize(0.05);
 		hist1d->GetYaxis()->SetTitle("count");
 		hist1d->GetYaxis()->SetTitleSize(0.05);
 		hist1d->Draw();
-		char buffer2[50];
-		sprintf(buffer2, "%s_%s.pdf", bankname, attribut_name);
-		canvas1->Print(buffer2);
+		std::string output = (single ? prefix : specs[i].name) + options.getSuffix() + ".pdf";
+		canvas1->Print(output.c_str());
 		delete hist1d;
 		delete canvas1;
 	}
-	else { 
-		printf("Please, all fields are mandatory...\n");
-		printf("Usage :\n");
-		printf("   ./hist1d filename bankname attribut type Nbins lower_value upper_value\n");
-		printf("   e.g /hist1d file.hipo AHDC::adc time -f 100 0.0 100.0\n");
-		return 0;
-	}
 }
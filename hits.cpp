@@ -18,42 +18,53 @@
 #include "TStyle.h"
 #include "TString.h"
 
+#include "fPipeline.h"
+#include "fChannelMap.h"
+
+#include <vector>
+#include <algorithm>
+
 
 int main(int argc, char const *argv[]){
 	
-	if (argc >= 1) { 
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	if (args.size() >= 2) { 
 		// open file and read bank
-		const char* filename = argv[1];
+		const char* filename = args[1];
 		
-		hipo::reader  reader(filename);
-		hipo::banklist banklist = reader.getBanks({"AHDC::adc", "AHDC::wf"});
-		long unsigned int nEvent = 0;
+		fPipeline pipeline(filename, {{"AHDC::adc", {"layer"}}});
+		if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+		const int item_layer = pipeline.getColumn(0, "layer");
 		// loop over events
-		while( reader.next(banklist)){
-			//printf(" ======= EVENT %ld =========\n", nEvent);
-			if (nEvent > 20000) { break;} // process only 20k events
-			bool flag11 = false, flag21 = false, flag22 = false, flag31 = false, flag32 = false, flag41 = false, flag42 = false, flag51 = false; 	
-			int nhits = 0;
+		std::vector<fEventIndex::Entry> events = pipeline.run<std::vector<fEventIndex::Entry>>(std::vector<fEventIndex::Entry>(),
+			[item_layer] (std::vector<fEventIndex::Entry>& selected, hipo::banklist& banklist, long nEvent) {
+			int flags = 0; // bit i : hit in the layer of index i (see fChannelMap)
 			for(int col = 0; col < banklist[0].getRows(); col++){ // loop over columns of the bankname
-				int layer = banklist[0].getInt("layer", col);
-				if      (layer == 11) { flag11 = true; nhits++;}
-				else if (layer == 21) { flag21 = true; nhits++;}
-				else if (layer == 22) { flag22 = true; nhits++;}
-				else if (layer == 31) { flag31 = true; nhits++;}
-				else if (layer == 32) { flag32 = true; nhits++;}
-				else if (layer == 41) { flag41 = true; nhits++;}
-				else if (layer == 42) { flag42 = true; nhits++;}
-				else if (layer == 51) { flag51 = true; nhits++;}
-				else                  { } // do nothing
+				int i = fChannelMap::getLayerIndex(banklist[0].getInt(item_layer, col));
+				flags |= (i >= 0) ? (1 << i) : 0;
 			}
-			nEvent++;
-			if (flag11 && flag21 && flag22 && flag31 && flag32 && flag41 && flag42 && flag51) {
-			//if (nhits > 6) {
-				printf(" ---> nEvent : %ld\n", nEvent);
+			if (flags == (1 << fChannelMap::nlayers) - 1) { // the 8 layers
+				selected.push_back(fPipeline::getCurrentEvent()); // record, position and nEvent
 			}
+		},
+		[] (std::vector<fEventIndex::Entry>& selected, const std::vector<fEventIndex::Entry>& other) {
+			selected.insert(selected.end(), other.begin(), other.end());
+		});
+		std::sort(events.begin(), events.end());
+		fEventIndex index("cosmics", pipeline.getNumberOfRecords());
+		for (const fEventIndex::Entry& event : events) {
+			printf(" ---> nEvent : %ld\n", (long) event.number + 1);
+			index.add(event);
+		}
+		// the selected events can be processed again with --index
+		std::string indexname = fEventIndex::getSidecarName(filename, "cosmics", options.getSuffix());
+		if (index.write(indexname)) {
+			printf("   > %s : %d events\n", indexname.c_str(), index.size());
 		}
 	}
 	else { 
 		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./hits.exe filename [options]\n%s", fPipeline::getOptionsUsage());
 	}
 }
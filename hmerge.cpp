@@ -0,0 +1,100 @@
+/****************************************************
+ * Merge the histogram files (.fhist) written by the
+ * shards of a run (see the option --shard)
+ *
+ * The histograms (and the profiles) with the same
+ * name are merged, they must have the same binning.
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * *************************************************/
+
+#include <string>
+#include <cstdio>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "fH1D.h"
+#include "fH2D.h"
+#include "fProfile.h"
+#include "fHistIO.h"
+
+
+int main(int argc, char const *argv[]){
+	
+	if (argc < 3) {
+		printf("Please, provide an output and the files to merge...\n");
+		printf("Usage :\n");
+		printf("   ./hmerge.exe output.fhist input1.fhist [input2.fhist ...]\n");
+		return 0;
+	}
+	const char* output = argv[1];
+	std::vector<std::string> names; // order of the first file
+	std::vector<std::unique_ptr<fH1D>> h1;
+	std::vector<std::unique_ptr<fH2D>> h2;
+	std::vector<std::unique_ptr<fProfile>> profiles;
+	std::vector<int> kinds;
+	for (int i = 2; i < argc; i++) {
+		fHistReader reader(argv[i]);
+		if (!reader.is_open()) {
+			printf("Cannot read %s\n", argv[i]);
+			return 1;
+		}
+		std::vector<std::string> seen; // names of this file
+		for (int j = 0; j < reader.getNumberOfObjects(); j++) {
+			fHistIO::IndexRecord rec;
+			reader.getRecord(j, rec);
+			std::string name = rec.name;
+			if (std::find(seen.begin(), seen.end(), name) != seen.end()) {
+				printf("%s : two histograms are named %s, they cannot be merged\n", argv[i], name.c_str());
+				return 1;
+			}
+			seen.push_back(name);
+			int k = 0;
+			while ((k < (int) names.size()) && (names[k] != name)) { k++;}
+			if (k == (int) names.size()) { // first time
+				names.push_back(name);
+				kinds.push_back(rec.kind);
+				h1.push_back(nullptr);
+				h2.push_back(nullptr);
+				profiles.push_back(nullptr);
+			}
+			bool ok = (rec.kind == (uint32_t) kinds[k]);
+			if (ok && (rec.kind == fHistIO::KIND_H1D)) {
+				std::unique_ptr<fH1D> h = reader.getH1D(j); // by position : the names are not always unique in older files
+				if (!h) { return 1;}
+				if (h1[k]) { ok = h1[k]->merge(*h);}
+				else { h1[k] = std::move(h);}
+			}
+			else if (ok && (rec.kind == fHistIO::KIND_H2D)) {
+				std::unique_ptr<fH2D> h = reader.getH2D(j);
+				if (!h) { return 1;}
+				if (h2[k]) { ok = h2[k]->merge(*h);}
+				else { h2[k] = std::move(h);}
+			}
+			else if (ok && (rec.kind == fHistIO::KIND_PROFILE)) {
+				std::unique_ptr<fProfile> p = reader.getProfile(j);
+				if (!p) { return 1;}
+				if (profiles[k]) { ok = profiles[k]->merge(*p);}
+				else { profiles[k] = std::move(p);}
+			}
+			if (!ok) {
+				printf("%s : %s cannot be merged (different binning)\n", argv[i], name.c_str());
+				return 1;
+			}
+		}
+		printf("   < %s : %d histograms\n", argv[i], reader.getNumberOfObjects());
+	}
+	fHistWriter writer;
+	for (int k = 0; k < (int) names.size(); k++) {
+		if (h1[k]) { writer.add(h1[k].get());}
+		if (h2[k]) { writer.add(h2[k].get());}
+		if (profiles[k]) { writer.add(profiles[k].get());}
+	}
+	if (!writer.write(output)) {
+		return 1;
+	}
+	printf("   > %s : %d histograms\n", output, (int) names.size());
+	return 0;
+}
@@ -18,91 +18,112 @@
 #include "TStyle.h"
 #include "TString.h"
 
+#include "fPipeline.h"
+#include "fChannelMap.h"
+
+#include <vector>
+#include <algorithm>
+
+/** Events with many hits in the outer layers */
+struct NoiseCount {
+	long unsigned int nEvent_full = 0;
+	long unsigned int nEvent_semi = 0;
+	long unsigned int nEvent_semi_semi = 0;
+	std::vector<std::vector<long>> lines; ///< event number, nhit, nhit_51, nhit_42 (printed in the event order at the end)
+	std::vector<fEventIndex::Entry> bursts; ///< events with more than 150 hits, saved in an index
+	fChannelArray<long> occupancy; ///< number of hits of each wire
+};
+
 
 int main(int argc, char const *argv[]){
 	
-	if (argc < 2) {
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	if (args.size() < 2) {
 		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./noise_count.exe filename [options]\n%s", fPipeline::getOptionsUsage());
 		return 0;
 	}
 
 	// open file and read bank
-	const char* filename = argv[1];
-	hipo::reader  reader(filename);
-	hipo::banklist banklist = reader.getBanks({"AHDC::adc","AHDC::wf"});
-	long unsigned int nEvent = 0;
-	
-	long unsigned int nEvent_full = 0;
-	long unsigned int nEvent_semi = 0;
-	long unsigned int nEvent_semi_semi = 0;
+	const char* filename = args[1];
+	fPipeline pipeline(filename, {{"AHDC::wf", {"layer", "component"}}});
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+
+	const int item_layer = pipeline.getColumn(0, "layer"); // column numbers in AHDC::wf
+	const int item_component = pipeline.getColumn(0, "component");
 
 	// loop over events
-	while( reader.next(banklist)){
-		//printf(" ======= EVENT %ld =========\n", nEvent);
-		if (nEvent > 20000) { break;} // process only 20k events
-		int nhit_51 = 0;
-		int nhit_42 = 0;
-		for(int col = 0; col < banklist[1].getRows(); col++){ // loop over columns of AHDC::wf 
-			// AHDC::wf --> samples
-			int layer = banklist[1].getInt("layer", col);
-			//int component = banklist[1].getInt("component", col);
-			// find the end the waveform (in case of Zero Suppress)
-			/*int nsamples = 50;
-			for (int bin = 1; bin <= nsamples; bin++){
-				char buffer[50];
-				sprintf(buffer, "s%d", bin); 
-				short value = banklist[1].getInt(buffer,col);
-				rms += value*value;
-			}*/
-			if (layer == 51) {
-				nhit_51++;
-			}
-			else if (layer == 42) {
-				nhit_42++;
-			}
-			/*else if (layer == 41) {
-			}
-			else if (layer == 32) {
-			}
-			else if (layer == 31) {
-			}
-			else if (layer == 22) {
-			}
-			else if (layer == 21) {
-			}
-			else if (layer == 11) {
-			}*/
-			else {
-				// do nothing
-			}
-			// AHDC::adc  --> decoded outputs
-			/*double adcMax = banklist[0].getInt("ADC", col);
-			double integral = banklist[0].getInt("integral", col);
-			double adcOffset = banklist[0].getInt("adcOffset", col);
-			double timeMax = banklist[0].getInt("time", col);
-			double timeRiseCFA = banklist[0].getInt("leadingEdgeTime", col);
-			double timeOT = banklist[0].getInt("timeOverThreshold", col);
-			double timeCFD = banklist[0].getInt("constantFractionTime", col);*/
+	NoiseCount result = pipeline.run<NoiseCount>(NoiseCount(),
+		[item_layer, item_component] (NoiseCount& count, hipo::banklist& banklist, long nEvent) {
+		int nhit_layer[fChannelMap::nlayers] = {0};
+		for(int col = 0; col < banklist[0].getRows(); col++){ // loop over columns of AHDC::wf 
+			int layer = banklist[0].getInt(item_layer, col);
+			int i = fChannelMap::getLayerIndex(layer);
+			if (i < 0) { continue;}
+			nhit_layer[i]++; // all the hits of the layer, as fNoiseModule
+			int channel = fChannelMap::getChannel(layer, banklist[0].getInt(item_component, col));
+			if (channel >= 0) { count.occupancy[channel]++;}
+			// AHDC::adc --> decoded outputs (ADC, integral, time...) : see fPulse and pulse.exe
 		}
+		int nhit_51 = nhit_layer[fChannelMap::getLayerIndex(51)];
+		int nhit_42 = nhit_layer[fChannelMap::getLayerIndex(42)];
 		int nhit = nhit_51 + nhit_42;
 		if (nhit > 150) { // 99 + 87 == 186
-			nEvent_full++;
-			printf("\033[31m   > nEvent : %5ld, nhit : %3d, nhit_51 : %3d, nhit_42 : %3d\n\033[0m", nEvent+1, nhit, nhit_51, nhit_42);
+			count.nEvent_full++;
+			count.lines.push_back({nEvent+1, nhit, nhit_51, nhit_42});
+			count.bursts.push_back(fPipeline::getCurrentEvent());
 		}
 		else if ((nhit > 80) && (nhit <= 150)) {
-			nEvent_semi++;
-			printf("\033[33m   > nEvent : %5ld, nhit : %3d, nhit_51 : %3d, nhit_42 : %3d\n\033[0m", nEvent+1, nhit, nhit_51, nhit_42);
+			count.nEvent_semi++;
+			count.lines.push_back({nEvent+1, nhit, nhit_51, nhit_42});
 		}
 		else if ((nhit > 20) && (nhit <= 80)) {
-			nEvent_semi_semi++;
-			printf("\033[32m   > nEvent : %5ld, nhit : %3d, nhit_51 : %3d, nhit_42 : %3d\n\033[0m", nEvent+1, nhit, nhit_51, nhit_42);
+			count.nEvent_semi_semi++;
+			count.lines.push_back({nEvent+1, nhit, nhit_51, nhit_42});
 		}
 		else {
 			// do nothing
 		}
-		nEvent++;
+	},
+	[] (NoiseCount& count, const NoiseCount& other) {
+		count.nEvent_full += other.nEvent_full;
+		count.nEvent_semi += other.nEvent_semi;
+		count.nEvent_semi_semi += other.nEvent_semi_semi;
+		count.lines.insert(count.lines.end(), other.lines.begin(), other.lines.end());
+		count.bursts.insert(count.bursts.end(), other.bursts.begin(), other.bursts.end());
+		count.occupancy.merge(other.occupancy);
+	});
+	std::sort(result.lines.begin(), result.lines.end());
+	for (const std::vector<long>& line : result.lines) {
+		long nhit = line[1];
+		const char* color = (nhit > 150) ? "\033[31m" : ((nhit > 80) ? "\033[33m" : "\033[32m");
+		printf("%s   > nEvent : %5ld, nhit : %3ld, nhit_51 : %3ld, nhit_42 : %3ld\n\033[0m", color, line[0], nhit, line[2], line[3]);
 	}
+	long unsigned int nEvent_full = result.nEvent_full;
+	long unsigned int nEvent_semi = result.nEvent_semi;
+	long unsigned int nEvent_semi_semi = result.nEvent_semi_semi;
 	printf("\033[31m nEvent_full       : %ld\n\033[0m", nEvent_full);
 	printf("\033[33m nEvent_semi       : %ld\n\033[0m", nEvent_semi);
 	printf("\033[32m nEvent_semi_semi  : %ld\n\033[0m", nEvent_semi_semi);
+	// wires with the most hits
+	std::vector<int> wires(fChannelMap::nchannels);
+	for (int channel = 0; channel < fChannelMap::nchannels; channel++) {
+		wires[channel] = channel;
+	}
+	std::stable_sort(wires.begin(), wires.end(), [&result] (int a, int b) { return result.occupancy[a] > result.occupancy[b];});
+	printf("Noisiest wires :\n");
+	for (int k = 0; k < 5; k++) {
+		int channel = wires[k];
+		printf("   > layer %d, component %2d : %ld hits\n", fChannelMap::getLayerOfChannel(channel), fChannelMap::getComponentOfChannel(channel), result.occupancy[channel]);
+	}
+	// the noise bursts can be processed again with --index
+	fEventIndex index("noise", pipeline.getNumberOfRecords());
+	for (const fEventIndex::Entry& event : result.bursts) {
+		index.add(event);
+	}
+	std::string indexname = fEventIndex::getSidecarName(filename, "noise", options.getSuffix());
+	if (index.write(indexname)) {
+		printf("   > %s : %d events\n", indexname.c_str(), index.size());
+	}
 }
@@ -0,0 +1,279 @@
+/****************************************************
+ * Pulse features computed again from the waveforms
+ *
+ * The columns of AHDC::adc (ADC, integral,
+ * adcOffset, time, leadingEdgeTime,
+ * timeOverThreshold, constantFractionTime) are
+ * computed from the samples of AHDC::wf with the
+ * parameters given on the command line (see
+ * fPulse), without the reconstruction. Their
+ * histograms are saved in pulse.fhist (see
+ * hmerge.exe for the shards).
+ *
+ * --compare : the hits are matched to the rows of
+ * AHDC::adc of the same event (layer, component),
+ * the differences (here - decoder) are saved in
+ * the histograms d_<column> and summarized per
+ * column.
+ *
+ * --bench : the extraction of each record is
+ * repeated and timed, the rate is given in hits/s
+ * per core (time spent in fPulse::extract only,
+ * summed over the threads).
+ *
+ * @author Felix Touchte Codjo
+ * @date October 18, 2026
+ * *************************************************/
+
+#include "reader.h"
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "fPipeline.h"
+#include "fWaveformBatch.h"
+#include "fPulse.h"
+#include "fCalibration.h"
+#include "fFormula.h"
+#include "fH1D.h"
+#include "fHistIO.h"
+
+/** agreement of a feature with the decoder */
+struct Agreement {
+	long n = 0;
+	long nclose = 0; ///< |difference| <= max(1, 1% of the decoder value)
+	double sum = 0;
+	double sum2 = 0;
+};
+
+/** state of a thread */
+struct PulseState {
+	fWaveformBatch batch; ///< waveforms of the current record
+	fPulseResults results;
+	fAlignedVector<float> pedestals; ///< with a calibration table
+	std::vector<fH1D> hists; ///< one per feature
+	// --compare : rows of AHDC::adc of the events of the batch
+	std::vector<fFormula> columns; ///< layer, component and the features
+	std::vector<std::vector<double>> adc; ///< values of each column, the rows of all the events
+	std::vector<double> values;
+	std::vector<int> adc_offset; ///< first row of each event, and the number of rows at the end
+	std::vector<fH1D> diffs; ///< one per feature
+	std::vector<Agreement> agreements;
+	long nmatched = 0;
+	long nwf_only = 0; ///< hits of AHDC::wf without a row in AHDC::adc
+	long nadc_only = 0;
+	// --bench
+	long nhits = 0;
+	double seconds = 0; ///< spent in fPulse::extract
+};
+
+int main(int argc, char const *argv[]){
+
+	// options of pulse.exe, the others are given to fPipeline
+	fPulse pulse;
+	bool compare = false;
+	bool bench = false;
+	int nrepeat = 10; // --bench
+	double sampling_time = 50;
+	std::string calib;
+	bool valid = true;
+	std::vector<const char*> rest;
+	for (int i = 0; i < argc; i++) {
+		bool has_value = (i + 1 < argc);
+		if      (strcmp(argv[i], "--compare") == 0)                      { compare = true;}
+		else if (strcmp(argv[i], "--bench") == 0)                        { bench = true;}
+		else if (strcmp(argv[i], "--parabola") == 0)                     { pulse.set_time_mode(PULSE_TIME_PARABOLA);}
+		else if ((strcmp(argv[i], "--fraction") == 0) && has_value)      { pulse.set_fraction(atof(argv[++i]));}
+		else if ((strcmp(argv[i], "--npedestal") == 0) && has_value)     { pulse.set_npedestal(atoi(argv[++i]));}
+		else if ((strcmp(argv[i], "--calib") == 0) && has_value)         { calib = argv[++i];}
+		else if ((strcmp(argv[i], "--sampling") == 0) && has_value)      { sampling_time = atof(argv[++i]);}
+		else if ((strcmp(argv[i], "--cfd") == 0) && (i + 2 < argc)) {
+			double cfd_fraction = atof(argv[i + 1]);
+			int cfd_delay = atoi(argv[i + 2]);
+			valid = valid && (cfd_fraction > 0) && (cfd_delay >= 1);
+			pulse.set_cfd(cfd_fraction, cfd_delay);
+			i += 2;
+		}
+		else { rest.push_back(argv[i]);}
+	}
+	pulse.set_sampling_time(sampling_time);
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(rest.size(), rest.data(), options);
+	if ((args.size() != 2) || !valid || (sampling_time <= 0)) {
+		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./pulse.exe filename [--compare] [--bench] [parameters] [options]\n");
+		printf("      --compare       differences with the columns of AHDC::adc\n");
+		printf("      --bench         extraction repeated %d times, hits/s per core\n", nrepeat);
+		printf("   parameters :\n");
+		printf("      --npedestal N   first samples averaged for the pedestal (1 by default)\n");
+		printf("      --calib file    pedestals of the wires (see calib.exe)\n");
+		printf("      --fraction F    of ADC for leadingEdgeTime and timeOverThreshold (0.5 by default)\n");
+		printf("      --cfd F D       fraction and delay (samples) of constantFractionTime (0.3 5 by default)\n");
+		printf("      --parabola      time of the peak from a parabola (first bin of the peak by default)\n");
+		printf("      --sampling T    ns per sample (50 by default)\n");
+		printf("%s", fPipeline::getOptionsUsage());
+		return 0;
+	}
+	const char* filename = args[1];
+	fCalibration calibration;
+	if (!calib.empty() && !calibration.map(calib)) { return 0;}
+
+	// AHDC::adc : the columns of the decoder
+	std::vector<std::string> adc_columns = {"layer", "component"};
+	for (int feature = 0; feature < PULSE_NFEATURES; feature++) {
+		adc_columns.push_back(fPulseResults::getFeatureName(feature));
+	}
+	std::vector<fColumns> projection = {{"AHDC::wf", fWaveformBatch::getColumns()}};
+	if (compare) {
+		projection.push_back({"AHDC::adc", adc_columns});
+	}
+	fPipeline pipeline(filename, projection);
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+
+	PulseState model = {fWaveformBatch(pipeline.getBank(0).getSchema())};
+	double tmax = fWaveformBatch::nsamples*sampling_time;
+	double upper[PULSE_NFEATURES] = {4096, 50000, 1000, tmax, tmax, tmax, tmax};
+	double spread[PULSE_NFEATURES] = {100, 1000, 50, 2*sampling_time, 2*sampling_time, 2*sampling_time, 2*sampling_time};
+	for (int feature = 0; feature < PULSE_NFEATURES; feature++) {
+		std::string name = fPulseResults::getFeatureName(feature);
+		model.hists.push_back(fH1D(name, 100, 0, upper[feature]));
+		model.diffs.push_back(fH1D("d_" + name, 100, -spread[feature], spread[feature]));
+		model.hists.back().set_xtitle(name);
+		model.diffs.back().set_xtitle(name + " - " + name + " (AHDC::adc)");
+	}
+	model.agreements.resize(PULSE_NFEATURES);
+	if (compare) {
+		hipo::schema& schema = pipeline.getBank(1).getSchema();
+		for (const std::string& column : adc_columns) {
+			model.columns.push_back(fFormula(column));
+			model.columns.back().compile(schema);
+		}
+		model.adc.resize(adc_columns.size());
+		model.adc_offset.push_back(0);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	PulseState result = pipeline.run<PulseState>(model,
+		[compare] (PulseState& state, hipo::banklist& banklist, long nEvent) {
+		state.batch.add_event(banklist[0], nEvent); // AHDC::wf
+		if (compare) { // AHDC::adc
+			for (int k = 0; k < (int) state.columns.size(); k++) {
+				state.columns[k].evaluate(banklist[1], state.values);
+				state.adc[k].insert(state.adc[k].end(), state.values.begin(), state.values.end());
+			}
+			state.adc_offset.push_back(state.adc[0].size());
+		}
+	},
+	[] (PulseState& state, const PulseState& other) {
+		for (int feature = 0; feature < PULSE_NFEATURES; feature++) {
+			state.hists[feature].merge(other.hists[feature]);
+			state.diffs[feature].merge(other.diffs[feature]);
+			Agreement& a = state.agreements[feature];
+			const Agreement& b = other.agreements[feature];
+			a.n += b.n;
+			a.nclose += b.nclose;
+			a.sum += b.sum;
+			a.sum2 += b.sum2;
+		}
+		state.nmatched += other.nmatched;
+		state.nwf_only += other.nwf_only;
+		state.nadc_only += other.nadc_only;
+		state.nhits += other.nhits;
+		state.seconds += other.seconds;
+	},
+	[&pulse, &calibration, &calib, compare, bench, nrepeat] (PulseState& state) { // all the waveforms of a record at once
+		fWaveformBatch& batch = state.batch;
+		int nhits = batch.getNumberOfHits();
+		const float* pedestals = nullptr;
+		if (!calib.empty()) {
+			state.pedestals.resize(nhits);
+			calibration.getPedestals(batch, state.pedestals.data());
+			pedestals = state.pedestals.data();
+		}
+		auto begin = std::chrono::steady_clock::now();
+		for (int repeat = 0; repeat < (bench ? nrepeat : 1); repeat++) {
+			pulse.extract(batch, state.results, pedestals);
+			state.nhits += nhits;
+		}
+		state.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		const fPulseResults& results = state.results;
+		for (int feature = 0; feature < PULSE_NFEATURES; feature++) {
+			for (int hit = 0; hit < nhits; hit++) {
+				state.hists[feature].fill(results.getFeature(feature, hit));
+			}
+		}
+		if (compare) { // a row of AHDC::adc is matched to the first hit of the same wire in the event
+			const int16_t* layers = batch.getLayers();
+			const int16_t* components = batch.getComponents();
+			std::vector<bool> used(nhits, false);
+			for (int ev = 0; ev < batch.getNumberOfEvents(); ev++) {
+				int first = batch.getFirstHit(ev), last = batch.getFirstHit(ev+1);
+				for (int row = state.adc_offset[ev]; row < state.adc_offset[ev+1]; row++) {
+					int hit = first;
+					while ((hit < last) && (used[hit] || (layers[hit] != state.adc[0][row]) || (components[hit] != state.adc[1][row]))) { hit++;}
+					if (hit == last) {
+						state.nadc_only++;
+						continue;
+					}
+					used[hit] = true;
+					state.nmatched++;
+					for (int feature = 0; feature < PULSE_NFEATURES; feature++) {
+						double reference = state.adc[2 + feature][row];
+						double d = results.getFeature(feature, hit) - reference;
+						state.diffs[feature].fill(d);
+						Agreement& a = state.agreements[feature];
+						a.n++;
+						a.nclose += (fabs(d) <= std::max(1.0, 0.01*fabs(reference)));
+						a.sum += d;
+						a.sum2 += d*d;
+					}
+				}
+				for (int hit = first; hit < last; hit++) {
+					state.nwf_only += !used[hit];
+				}
+			}
+			for (std::vector<double>& column : state.adc) {
+				column.clear();
+			}
+			state.adc_offset.assign(1, 0);
+		}
+		batch.clear();
+	});
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// histograms of the shard, see hmerge.exe
+	fHistWriter writer;
+	for (const fH1D& h : result.hists) {
+		writer.add(&h);
+	}
+	if (compare) {
+		for (const fH1D& h : result.diffs) {
+			writer.add(&h);
+		}
+	}
+	writer.write("pulse" + options.getSuffix() + ".fhist");
+	long nhits = bench ? result.nhits/nrepeat : result.nhits;
+	printf("%ld hits in %.2lf s\n", nhits, seconds);
+	if (bench) {
+		printf("fPulse::extract : %.3lg hits/s per core (%d threads, %d repetitions), %.3lg hits/s with the reading of the file\n",
+			result.nhits/result.seconds, pipeline.getNumberOfThreads(), nrepeat, nhits/seconds);
+	}
+	if (compare) {
+		printf("AHDC::adc : %ld hits matched, %ld hits of AHDC::wf and %ld rows of AHDC::adc without match\n", result.nmatched, result.nwf_only, result.nadc_only);
+		printf("%-22s %12s %12s %10s\n", "column", "mean diff", "rms diff", "agree");
+		for (int feature = 0; feature < PULSE_NFEATURES; feature++) {
+			const Agreement& a = result.agreements[feature];
+			if (a.n == 0) { continue;}
+			double mean = a.sum/a.n;
+			double rms = sqrt(a.sum2/a.n);
+			printf("%-22s %12.3lf %12.3lf %9.2lf%%\n", fPulseResults::getFeatureName(feature), mean, rms, 100.0*a.nclose/a.n);
+		}
+	}
+	return 0;
+}
@@ -9,6 +9,7 @@
 
 #include <string>
 #include <cstdio>
+#include <cmath>
 
 #include "TH1.h"
 #include "TH2.h"
@@ -18,94 +19,147 @@
 #include "TStyle.h"
 #include "TString.h"
 
+#include <cairommconfig.h>
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+
+#include "fProfile.h"
+#include "fRoot.h"
+#include "fPipeline.h"
+#include "fWaveformBatch.h"
+#include "fKernels.h"
+#include "fHistIO.h"
+#include "fChannelMap.h"
+#include "fCalibration.h"
+#include "fH1DCompact.h"
+
+#include <vector>
+
+/** RMS distribution of one wire, 100 bins inline */
+using WireRms = fH1DCompact<uint32_t, 100>;
+static_assert(sizeof(WireRms) >= 100*sizeof(uint32_t), "the bins of WireRms are stored inline");
+
+/** RMS of the signals per wire */
+struct RmsState {
+	std::vector<WireRms> wire_rms; ///< one per wire
+	fProfile prof_rms; ///< mean RMS of each wire
+	fWaveformBatch batch; ///< waveforms of the current record
+	fWaveformStats stats; ///< length, sum of squares... of the waveforms of the batch
+	// with a calibration table
+	fAlignedVector<float> pedestals; ///< of the hits of the batch
+	fAlignedVector<float> corrected; ///< samples minus the pedestals, same layout as the batch
+	fAlignedVector<double> sumsq; ///< sum of the squared corrected samples of each hit
+};
+
+/** one histogram per layer : sum of the RMS distributions of its wires */
+static std::vector<fH1D> getLayerHistograms(const RmsState& state) {
+	std::vector<fH1D> layers;
+	for (int i = 0; i < fChannelMap::nlayers; i++) {
+		char title[50];
+		sprintf(title, "RMS signals in Layer %d", i + 1);
+		layers.push_back(fH1D(title, 100, 0, 500));
+		int first = fChannelMap::getFirstChannel(i);
+		for (int wire = first; wire < first + fChannelMap::getNumberOfWires(i); wire++) {
+			layers[i].merge(state.wire_rms[wire].to_fH1D(title));
+		}
+	}
+	return layers;
+}
+
 
 int main(int argc, char const *argv[]){
 	
-	if (argc < 2) {
-		printf("Please, provide a filename...");
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	if (args.size() < 2) {
+		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./rms.exe filename [calibration] [options]\n");
+		printf("      calibration : pedestals of the wires (see calib.exe), the RMS is computed around them\n");
+		printf("%s", fPipeline::getOptionsUsage());
 		return 0;
 	}
 
 	// open file and read bank
-	const char* filename = argv[1];
-	hipo::reader  reader(filename);
-	hipo::banklist banklist = reader.getBanks({"AHDC::adc","AHDC::wf"});
-	long unsigned int nEvent = 0;
+	const char* filename = args[1];
+	fPipeline pipeline(filename, {{"AHDC::wf", fWaveformBatch::getColumns()}});
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+	fCalibration calibration;
+	bool calibrated = (args.size() >= 3);
+	if (calibrated && !calibration.map(args[2])) { return 0;}
 	
-	TH1D* hist1d_rms1 = new TH1D("hist1d_rms1", "RMS signals in Layer 1", 100, 0, 500);
-	TH1D* hist1d_rms2 = new TH1D("hist1d_rms2", "RMS signals in Layer 2", 100, 0, 500);
-	TH1D* hist1d_rms3 = new TH1D("hist1d_rms3", "RMS signals in Layer 3", 100, 0, 500);
-	TH1D* hist1d_rms4 = new TH1D("hist1d_rms4", "RMS signals in Layer 4", 100, 0, 500);
-	TH1D* hist1d_rms5 = new TH1D("hist1d_rms5", "RMS signals in Layer 5", 100, 0, 500);
-	TH1D* hist1d_rms6 = new TH1D("hist1d_rms6", "RMS signals in Layer 6", 100, 0, 500);
-	TH1D* hist1d_rms7 = new TH1D("hist1d_rms7", "RMS signals in Layer 7", 100, 0, 500);
-	TH1D* hist1d_rms8 = new TH1D("hist1d_rms8", "RMS signals in Layer 8", 100, 0, 500);
+	RmsState model = {std::vector<WireRms>(fChannelMap::nchannels, WireRms(0, 500)), fProfile("Mean RMS per wire", fChannelMap::nchannels, 0, fChannelMap::nchannels), fWaveformBatch(pipeline.getBank(0).getSchema()), fWaveformStats(), {}, {}, {}};
+	model.prof_rms.set_xtitle("wire number (layers 11 to 51)");
+	model.prof_rms.set_ytitle("RMS");
+
+	printf("RMS kernels : %s\n", fKernels::getIsaName(fKernels::getBestIsa()));
 
 	// loop over events
-	while( reader.next(banklist)){
-		//printf(" ======= EVENT %ld =========\n", nEvent);
-		for(int col = 0; col < banklist[1].getRows(); col++){ // loop over columns of AHDC::wf 
-			// AHDC::wf --> samples
-			int layer = banklist[1].getInt("layer", col);
-			//int component = banklist[1].getInt("component", col);
-			// find the end the waveform (in case of Zero Suppress)
-			int nsamples = 50;
-			for (int bin = 50; bin >= 1; bin--){
-				char buffer[50];
-				sprintf(buffer, "s%d", bin); 
-				short value = banklist[1].getInt(buffer,col);
-				if (value != 0) { 
-					nsamples = bin;
-					break;
+	RmsState result = pipeline.run<RmsState>(model,
+		[] (RmsState& state, hipo::banklist& banklist, long nEvent) {
+		state.batch.add_event(banklist[0], nEvent); // AHDC::wf
+	},
+	[] (RmsState& state, const RmsState& other) {
+		for (int wire = 0; wire < fChannelMap::nchannels; wire++) {
+			state.wire_rms[wire].merge(other.wire_rms[wire]);
+		}
+		state.prof_rms.merge(other.prof_rms);
+	},
+	[&calibration, calibrated] (RmsState& state) { // all the waveforms of a record at once
+		fWaveformBatch& batch = state.batch;
+		int nhits = batch.getNumberOfHits();
+		// find the end the waveform (in case of Zero Suppress) and the sum of squares
+		fKernels::waveform_stats(batch, state.stats);
+		const int16_t* length = state.stats.length.data();
+		if (calibrated) { // sum of squares of the valid samples around the pedestal of the wire
+			state.pedestals.resize(nhits);
+			calibration.getPedestals(batch, state.pedestals.data());
+			fKernels::subtract_pedestals(batch, state.pedestals.data(), state.corrected);
+			state.sumsq.assign(nhits, 0.0);
+			double* sumsq = state.sumsq.data();
+			for (int s = 0; s < fWaveformBatch::nsamples; s++) {
+				const float* c = state.corrected.data() + s*batch.getStride();
+				#pragma omp simd
+				for (int hit = 0; hit < nhits; hit++) {
+					sumsq[hit] += (s < length[hit]) ? ((double) c[hit])*c[hit] : 0.0;
 				}
 			}
-			double rms = 0.0;
-			for (int bin = 1; bin <= nsamples; bin++){
-				char buffer[50];
-				sprintf(buffer, "s%d", bin); 
-				short value = banklist[1].getInt(buffer,col);
-				rms += value*value;
-			}
-			rms = sqrt(rms/nsamples);
-			if (layer == 51) {
-				//printf("   > layer : %2.0d , wire : %2.0d, nsamples : %2.0d , rms : %lf\n", layer, component, nsamples, rms);
-			       	hist1d_rms8->Fill(rms);	
-			}
-			else if (layer == 42) {
-				hist1d_rms7->Fill(rms);
-			}
-			else if (layer == 41) {
-				hist1d_rms6->Fill(rms);
-			}
-			else if (layer == 32) {
-				hist1d_rms5->Fill(rms);
-			}
-			else if (layer == 31) {
-				hist1d_rms4->Fill(rms);
-			}
-			else if (layer == 22) {
-				hist1d_rms3->Fill(rms);
-			}
-			else if (layer == 21) {
-				hist1d_rms2->Fill(rms);
-			}
-			else if (layer == 11) {
-				hist1d_rms1->Fill(rms);
-			}
-			else {
-				// do nothing
-			}
-			// AHDC::adc  --> decoded outputs
-			/*double adcMax = banklist[0].getInt("ADC", col);
-			double integral = banklist[0].getInt("integral", col);
-			double adcOffset = banklist[0].getInt("adcOffset", col);
-			double timeMax = banklist[0].getInt("time", col);
-			double timeRiseCFA = banklist[0].getInt("leadingEdgeTime", col);
-			double timeOT = banklist[0].getInt("timeOverThreshold", col);
-			double timeCFD = banklist[0].getInt("constantFractionTime", col);*/
 		}
-		nEvent++;
+		for (int hit = 0; hit < nhits; hit++) {
+			int wire = fChannelMap::getChannel(batch.getLayers()[hit], batch.getComponents()[hit]);
+			if (wire < 0) { continue;}
+			double rms = calibrated ? sqrt(state.sumsq[hit]/length[hit]) : state.stats.getRms(hit);
+			state.prof_rms.fill_bins(&wire, &rms, 1);
+			state.wire_rms[wire].fill(rms);
+			// AHDC::adc --> decoded outputs (ADC, integral, time...) : see fPulse and pulse.exe
+		}
+		batch.clear();
+	},
+	[&options] (const RmsState& state) { // --follow : histograms so far
+		std::vector<fH1D> hist1d_rms = getLayerHistograms(state);
+		fHistWriter writer;
+		for (const fH1D& h : hist1d_rms) {
+			writer.add(&h);
+		}
+		writer.add(&state.prof_rms);
+		writer.write("rms" + options.getSuffix() + ".fhist");
+	});
+	fProfile& prof_rms = result.prof_rms;
+	std::vector<fH1D> hist1d_rms = getLayerHistograms(result);
+	// histograms of the shard, see hmerge.exe
+	fHistWriter writer;
+	for (const fH1D& h : hist1d_rms) {
+		writer.add(&h);
 	}
+	writer.add(&prof_rms);
+	writer.write("rms" + options.getSuffix() + ".fhist");
+	TH1D* hist1d_rms1 = to_TH1D(hist1d_rms[0], "hist1d_rms1");
+	TH1D* hist1d_rms2 = to_TH1D(hist1d_rms[1], "hist1d_rms2");
+	TH1D* hist1d_rms3 = to_TH1D(hist1d_rms[2], "hist1d_rms3");
+	TH1D* hist1d_rms4 = to_TH1D(hist1d_rms[3], "hist1d_rms4");
+	TH1D* hist1d_rms5 = to_TH1D(hist1d_rms[4], "hist1d_rms5");
+	TH1D* hist1d_rms6 = to_TH1D(hist1d_rms[5], "hist1d_rms6");
+	TH1D* hist1d_rms7 = to_TH1D(hist1d_rms[6], "hist1d_rms7");
+	TH1D* hist1d_rms8 = to_TH1D(hist1d_rms[7], "hist1d_rms8");
 	TCanvas* canvas1 = new TCanvas("c1","c1 title",1400, 800);
 	canvas1->Divide(4,2);
 	gStyle->SetOptStat("nemruo");
@@ -158,7 +212,15 @@ int main(int argc, char const *argv[]){
         hist1d_rms8->GetYaxis()->SetTitleSize(0.05);
         hist1d_rms8->Draw();
 	
-	canvas1->Print("./rms.pdf");
+	canvas1->Print(("./rms" + options.getSuffix() + ".pdf").c_str());
+	// Profile
+	int width = 1400;
+	int height = 800;
+	auto surface = Cairo::PdfSurface::create("rms_profile" + options.getSuffix() + ".pdf", width, height);
+	auto cr = Cairo::Context::create(surface);
+	prof_rms.set_error_mode(PROFILE_ERROR_SPREAD);
+	prof_rms.draw_with_cairo(cr, width, height);
+	cr->show_page();
 	delete hist1d_rms1;
 	delete hist1d_rms2;
 	delete hist1d_rms3;
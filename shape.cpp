@@ -23,7 +23,33 @@
 #include "TMultiGraph.h"
 #include "Math/PdfFuncMathCore.h"
 
-bool is_recognized (std::vector<double> samples, std::vector<double> vx, std::string title, bool verbose = false) {  // vx : corresponding x axis values
+#include "fPipeline.h"
+#include "fWaveformBatch.h"
+#include "fShape.h"
+#include "fCalibration.h"
+
+#include <algorithm>
+
+/** A recognized signal, drawn after the event loop (ROOT is not thread safe) */
+struct Signal {
+	long event;
+	int layer;
+	int component;
+	std::vector<double> samples;
+	double pedestal; ///< as used by fShape
+	bool operator<(const Signal& other) const { return event < other.event;}
+};
+
+/** waveforms of the current record and recognized signals of a thread */
+struct ShapeState {
+	fWaveformBatch batch;
+	fShapeResults results; ///< reused from one record to the next
+	fAlignedVector<float> pedestals; ///< of the hits of the batch, with a calibration table
+	std::vector<Signal> signals; ///< signals to be drawn
+	long nSignals; ///< all the recognized signals
+};
+
+bool is_recognized (const std::vector<double>& samples, const std::vector<double>& vx, std::string title, bool verbose = false, double pedestal = NAN) {  // vx : corresponding x axis values, pedestal : first sample if NAN
 	int Npts = samples.size();
 	if ((Npts < 1) || ((int) vx.size() != Npts)){
 		return false;
@@ -69,7 +95,9 @@ bool is_recognized (std::vector<double> samples, std::vector<double> vx, std::st
 	 * ***********************************************************/
 
 	// Estimate the pedestal ("adcOffset") of the signal with the fisrt bin (convenient with AHDC signals)
-	double pedestal = samples[0];
+	if (std::isnan(pedestal)) {
+		pedestal = samples[0];
+	}
 	std::vector<double> samplesCorr(Npts, 0.0);
 	for (int i = 0; i < Npts; i++) {
 		samplesCorr[i] = std::max(samples[i] - pedestal, 0.0);
@@ -209,47 +237,72 @@ int main(int argc, char const *argv[]){
 	test1();
 	test2();
 	
-	if (argc < 2) {
+	fPipelineOptions options;
+	std::vector<const char*> args = fPipeline::parse_options(argc, argv, options);
+	if (args.size() < 2) {
 		printf("Please, provide a filename...\n");
+		printf("Usage :\n   ./shape.exe filename [calibration] [options]\n");
+		printf("      calibration : pedestals of the wires (see calib.exe), the first sample by default\n");
+		printf("%s", fPipeline::getOptionsUsage());
 		return 0;
 	}
 
 	// open file and read bank
-	const char* filename = argv[1];
-	hipo::reader  reader(filename);
-	hipo::banklist banklist = reader.getBanks({"AHDC::adc","AHDC::wf"});
-	long unsigned int nEvent = 0;
-	long unsigned int nSignals = 0;
+	const char* filename = args[1];
+	fPipeline pipeline(filename, {{"AHDC::wf", fWaveformBatch::getColumns()}});
+	if (!pipeline.is_valid() || !pipeline.set_options(options)) { return 0;}
+	const long max_drawn_events = pipeline.getShardOffset() + options.first + 10001; // the signals of the first 10k events are drawn
+	const fShape shape; // same criteria as is_recognized
+	fCalibration calibration;
+	bool calibrated = (args.size() >= 3);
+	if (calibrated && !calibration.map(args[2])) { return 0;}
 	// loop over events
-	while( reader.next(banklist)){
-		if (nEvent % 1000 == 0) {
-			printf("Begin EVENT %ld\n", nEvent);
+	ShapeState model = {fWaveformBatch(pipeline.getBank(0).getSchema()), fShapeResults(), {}, {}, 0};
+	ShapeState result = pipeline.run<ShapeState>(model,
+		[] (ShapeState& state, hipo::banklist& banklist, long nEvent) {
+		state.batch.add_event(banklist[0], nEvent); // AHDC::wf
+	},
+	[] (ShapeState& state, const ShapeState& other) {
+		state.signals.insert(state.signals.end(), other.signals.begin(), other.signals.end());
+		state.nSignals += other.nSignals;
+	},
+	[&shape, &calibration, calibrated, max_drawn_events] (ShapeState& state) { // all the waveforms of a record at once
+		fWaveformBatch& batch = state.batch;
+		if (calibrated) {
+			state.pedestals.resize(batch.getNumberOfHits());
+			calibration.getPedestals(batch, state.pedestals.data());
 		}
-		if (nEvent > 10000) { break;} // process only 20k events
-		for(int col = 0; col < banklist[1].getRows(); col++){ // loop over columns of AHDC::wf 
-			int layer = banklist[1].getInt("layer", col);
-			int component = banklist[1].getInt("component", col);
-			std::vector<double> samples;
-			for (int bin = 1; bin <= 50; bin++){
-				char buffer[50];
-				sprintf(buffer, "s%d", bin); 
-				short value = banklist[1].getInt(buffer,col);
-				samples.push_back((double) value);
-			}
-			std::vector<double> vx((int) samples.size(), 0.0);
-			for (int i = 0; i < (int) samples.size(); i++) {
-				vx[i] = i;
-			}
-
-			char buffer[50];
-			sprintf(buffer, "./output/cosmics_%ld_%d_%d.png", nEvent+1, layer, component); 
-			if (is_recognized(samples, vx, buffer, true)) {
-				nSignals++;
-				printf("Event : %4ld, layer : %d, component : %d\n", nEvent+1, layer, component);
+		shape.classify(batch, state.results, calibrated ? state.pedestals.data() : nullptr);
+		for (int ev = 0; ev < batch.getNumberOfEvents(); ev++) {
+			long nEvent = batch.getEventNumber(ev);
+			for (int hit = batch.getFirstHit(ev); hit < batch.getFirstHit(ev+1); hit++) {
+				if (!state.results.is_recognized(hit)) { continue;}
+				state.nSignals++;
+				if (nEvent < max_drawn_events) {
+					std::vector<double> samples(fWaveformBatch::nsamples, 0.0);
+					for (int s = 0; s < fWaveformBatch::nsamples; s++) {
+						samples[s] = batch.getSample(hit, s);
+					}
+					double pedestal = calibrated ? lrintf(state.pedestals[hit]) : samples[0];
+					state.signals.push_back(Signal{nEvent, batch.getLayers()[hit], batch.getComponents()[hit], samples, pedestal});
+				}
 			}
 		}
-		nEvent++;
+		batch.clear();
+	});
+	std::vector<Signal>& signals = result.signals;
+	std::stable_sort(signals.begin(), signals.end());
+	std::vector<double> vx(fWaveformBatch::nsamples, 0.0);
+	for (int i = 0; i < (int) vx.size(); i++) {
+		vx[i] = i;
+	}
+	for (const Signal& signal : signals) {
+		char buffer[50];
+		sprintf(buffer, "./output/cosmics_%ld_%d_%d.png", signal.event+1, signal.layer, signal.component); 
+		is_recognized(signal.samples, vx, buffer, true, signal.pedestal); // draw
+		printf("Event : %4ld, layer : %d, component : %d\n", signal.event+1, signal.layer, signal.component);
 	}
+	long nSignals = result.nSignals;
 	printf("nSignals : %ld\n", nSignals);
 	return 0;
 }